@@ -0,0 +1,76 @@
+#include "SWAttemptBinary.h"
+
+#include "SWAttemptStore.h"
+
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/PlatformFileManager.h>
+#include <Misc/FileHelper.h>
+
+bool FSWAttemptBinary::ReadLast( const FString & fileName, const int nbLastAttempts, FSWAttemptStore & attempts, const int nbSkipped )
+{
+    attempts.Reset();
+
+    TUniquePtr< IMappedFileHandle > mappedFile( FPlatformFileManager::Get().GetPlatformFile().OpenMapped( *fileName ) );
+    if ( !mappedFile || mappedFile->GetFileSize() < static_cast< int64 >( sizeof( FSWAttemptFileHeader ) ) )
+        return false;
+
+    const auto fileSize = mappedFile->GetFileSize();
+    TUniquePtr< IMappedFileRegion > region( mappedFile->MapRegion( 0, fileSize ) );
+    if ( !region )
+        return false;
+
+    const auto * data = region->GetMappedPtr();
+    FSWAttemptFileHeader header;
+    FMemory::Memcpy( &header, data, sizeof( header ) );
+    if ( !header.IsValid() )
+        return false;
+
+    //Les N derniers essais : arithmetique de pointeurs, pas de parsing
+    const auto nbRecords = FMath::Max( static_cast< int32 >( ( fileSize - sizeof( header ) ) / header.RecordSize ) - nbSkipped, 0 );
+    const auto nb = nbLastAttempts < 0 ? nbRecords : FMath::Min( nbLastAttempts, nbRecords );
+    const auto * record = data + sizeof( header ) + static_cast< int64 >( nbRecords - nb ) * header.RecordSize;
+
+    attempts.NumThetas = header.NbThetas;
+    attempts.Results.SetNumUninitialized( nb );
+    attempts.Thetas.SetNumUninitialized( nb * header.NbThetas );
+    const auto thetasSize = header.NbThetas * sizeof( float );
+    for ( auto index = 0; index < nb; ++index, record += header.RecordSize )
+    {
+        FMemory::Memcpy( attempts.Thetas.GetData() + index * header.NbThetas, record, thetasSize );
+        FMemory::Memcpy( attempts.Results.GetData() + index, record + thetasSize, sizeof( float ) );
+    }
+
+    //La region doit etre liberee avant le fichier
+    region.Reset();
+    return true;
+}
+
+bool FSWAttemptBinary::ReadHeader( const FString & fileName, FSWAttemptFileHeader & header )
+{
+    TUniquePtr< IFileHandle > file( FPlatformFileManager::Get().GetPlatformFile().OpenRead( *fileName ) );
+    if ( !file || file->Size() < static_cast< int64 >( sizeof( header ) ) )
+        return false;
+
+    return file->Read( reinterpret_cast< uint8 * >( &header ), sizeof( header ) ) && header.IsValid();
+}
+
+void FSWAttemptBinary::AppendRecord( TArray< uint8 > & buffer, const FSWAttemptFileHeader & header, const float * thetas, const float result, const int64 ticks )
+{
+    buffer.Append( reinterpret_cast< const uint8 * >( thetas ), header.NbThetas * sizeof( float ) );
+    buffer.Append( reinterpret_cast< const uint8 * >( &result ), sizeof( float ) );
+    if ( header.HasTimestamps() )
+        buffer.Append( reinterpret_cast< const uint8 * >( &ticks ), sizeof( int64 ) );
+}
+
+bool FSWAttemptBinary::Save( const FString & fileName, const FSWAttemptsView & attempts )
+{
+    const auto header = FSWAttemptFileHeader::Make( attempts.NumThetas, false );
+
+    TArray< uint8 > buffer;
+    buffer.Reserve( sizeof( header ) + attempts.Num() * header.RecordSize );
+    buffer.Append( reinterpret_cast< const uint8 * >( &header ), sizeof( header ) );
+    for ( auto index = 0; index < attempts.Num(); ++index )
+        AppendRecord( buffer, header, attempts.GetThetas( index ), attempts.GetResult( index ), 0 );
+
+    return FFileHelper::SaveArrayToFile( buffer, *fileName );
+}
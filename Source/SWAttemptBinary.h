@@ -0,0 +1,61 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+struct FSWAttemptsView;
+struct FSWAttemptStore;
+
+// Header of a binary attempt file, followed by fixed-size records, the oldest first :
+// NbThetas floats, the result (float), then the time of the attempt (int64 FDateTime ticks, UTC) if FlagTimestamps is set.
+// Values are stored as they are in memory (little endian), without alignment.
+struct FSWAttemptFileHeader
+{
+    static constexpr uint32 FileMagic = 0x54415753; //"SWAT"
+    static constexpr uint16 CurrentVersion = 1;
+    static constexpr uint16 FlagTimestamps = 1;
+
+    uint32 Magic = FileMagic;
+    uint16 Version = CurrentVersion;
+    uint16 Flags = 0;
+    int32 NbThetas = 0;
+    int32 RecordSize = 0;
+
+    static FSWAttemptFileHeader Make( const int32 nbThetas, const bool bTimestamps )
+    {
+        FSWAttemptFileHeader header;
+        header.NbThetas = nbThetas;
+        header.Flags = bTimestamps ? FlagTimestamps : 0;
+        header.RecordSize = ( nbThetas + 1 ) * sizeof( float ) + ( bTimestamps ? sizeof( int64 ) : 0 );
+        return header;
+    }
+
+    bool IsValid() const
+    {
+        return Magic == FileMagic && Version == CurrentVersion && NbThetas >= 0
+            && RecordSize == Make( NbThetas, ( Flags & FlagTimestamps ) != 0 ).RecordSize;
+    }
+
+    bool HasTimestamps() const
+    {
+        return ( Flags & FlagTimestamps ) != 0;
+    }
+};
+
+static_assert( sizeof( FSWAttemptFileHeader ) == 16, "The header is written as is in the attempt files" );
+
+struct SWARMS_API FSWAttemptBinary
+{
+    // The nbLastAttempts last attempts of the file (all of them if nbLastAttempts < 0) in attempts, without the nbSkipped most recent ones.
+    // The file is memory-mapped : only the records read are loaded. A record still being written is ignored.
+    // Returns false if the file is missing or is not an attempt file (attempts is then empty)
+    static bool ReadLast( const FString & fileName, int nbLastAttempts, FSWAttemptStore & attempts, int nbSkipped = 0 );
+
+    // Header of an existing file, false if it is missing or is not an attempt file
+    static bool ReadHeader( const FString & fileName, FSWAttemptFileHeader & header );
+
+    // Appends one record to buffer
+    static void AppendRecord( TArray< uint8 > & buffer, const FSWAttemptFileHeader & header, const float * thetas, float result, int64 ticks );
+
+    // Replaces the file with these attempts (without timestamps)
+    static bool Save( const FString & fileName, const FSWAttemptsView & attempts );
+};
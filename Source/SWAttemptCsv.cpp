@@ -0,0 +1,340 @@
+#include "SWAttemptCsv.h"
+
+#include "SWAttemptStore.h"
+
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/PlatformFileManager.h>
+#include <Misc/FileHelper.h>
+
+namespace
+{
+    //Taille du premier bloc lu depuis la fin du fichier, doublee a chaque bloc suivant
+    const int64 TailFirstBlockSize = 4 * 1024;
+    const int64 TailMaxBlockSize = 1024 * 1024;
+
+    // Reads the end of a file backwards, block by block : Text holds the end of the file, oldest block first.
+    // Files are written one byte per char by addAttempt. A missing file gives an empty text
+    class FTailReader
+    {
+    public:
+        explicit FTailReader( const FString & fileName )
+            : File( FPlatformFileManager::Get().GetPlatformFile().OpenRead( *fileName ) )
+        {
+            if ( File )
+                Size = Position = File->Size();
+        }
+
+        // Prepends blocks until Text holds more than nbNewLines line ends (the one ending the file does not count) or the whole file
+        void ReadNewLines( const int nbNewLines )
+        {
+            TArray< ANSICHAR > block;
+            while ( Position > 0 && NbNewLines <= nbNewLines )
+            {
+                const auto nb = static_cast< int32 >( FMath::Min( BlockSize, Position ) );
+                Position -= nb;
+
+                block.SetNumUninitialized( nb );
+                if ( !File->Seek( Position ) || !File->Read( reinterpret_cast< uint8 * >( block.GetData() ), nb ) )
+                {
+                    Text.Reset();
+                    Position = 0;
+                    return;
+                }
+
+                for ( auto index = 0; index < nb; ++index )
+                {
+                    if ( block[ index ] == '\n' && Position + index != Size - 1 )
+                        NbNewLines++;
+                }
+
+                block.Append( Text );
+                Swap( block, Text );
+                BlockSize = FMath::Min( BlockSize * 2, TailMaxBlockSize );
+            }
+
+            //UTF-8 BOM d'un fichier edite a la main
+            if ( Position == 0 && !bBomChecked )
+            {
+                bBomChecked = true;
+                if ( Text.Num() >= 3 && Text[ 0 ] == '\xEF' && Text[ 1 ] == '\xBB' && Text[ 2 ] == '\xBF' )
+                    Text.RemoveAt( 0, 3 );
+            }
+        }
+
+        // Otherwise the first line of Text is cut
+        bool IsFromStart() const
+        {
+            return Position == 0;
+        }
+
+        TArray< ANSICHAR > Text;
+        int NbNewLines = 0;
+
+    private:
+        TUniquePtr< IFileHandle > File;
+        int64 Size = 0;
+        int64 Position = 0;
+        int64 BlockSize = TailFirstBlockSize;
+        bool bBomChecked = false;
+    };
+
+    const double PowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    bool IsDigit( const ANSICHAR c )
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    //'\r' des fins de ligne Windows compris
+    void SkipSpaces( const ANSICHAR *& c, const ANSICHAR * end )
+    {
+        while ( c < end && ( *c == ' ' || *c == '\t' || *c == '\r' ) )
+            ++c;
+    }
+
+    void SkipLine( const ANSICHAR *& c, const ANSICHAR * end )
+    {
+        while ( c < end && *c != '\n' )
+            ++c;
+        if ( c < end )
+            ++c;
+    }
+}
+
+float FSWAttemptCsv::ParseFloat( const ANSICHAR *& c, const ANSICHAR * end )
+{
+    const auto * start = c;
+
+    auto bNegative = false;
+    if ( c < end && ( *c == '-' || *c == '+' ) )
+    {
+        bNegative = *c == '-';
+        ++c;
+    }
+
+    //Mantisse entiere sur 19 chiffres significatifs au plus (tient dans un uint64), les suivants ne comptent pas
+    uint64 mantissa = 0;
+    auto nbSignificant = 0;
+    auto nbDigits = 0;
+    auto exponent = 0;
+    for ( ; c < end && IsDigit( *c ); ++c, ++nbDigits )
+    {
+        if ( nbSignificant < 19 )
+        {
+            mantissa = mantissa * 10 + ( *c - '0' );
+            nbSignificant += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if ( c < end && *c == '.' )
+    {
+        for ( ++c; c < end && IsDigit( *c ); ++c, ++nbDigits )
+        {
+            if ( nbSignificant < 19 )
+            {
+                mantissa = mantissa * 10 + ( *c - '0' );
+                nbSignificant += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    if ( nbDigits == 0 )
+    {
+        //inf, nan... : rare, on laisse faire Atof sur une copie du token
+        ANSICHAR token[ 64 ];
+        auto length = 0;
+        for ( c = start; c < end && *c != ';' && *c != '\n' && length < 63; ++c )
+            token[ length++ ] = *c;
+        token[ length ] = 0;
+        return FCStringAnsi::Atof( token );
+    }
+
+    if ( c < end && ( *c == 'e' || *c == 'E' ) )
+    {
+        const auto * exponentStart = c;
+        ++c;
+        auto bNegativeExponent = false;
+        if ( c < end && ( *c == '-' || *c == '+' ) )
+        {
+            bNegativeExponent = *c == '-';
+            ++c;
+        }
+
+        if ( c < end && IsDigit( *c ) )
+        {
+            auto value = 0;
+            for ( ; c < end && IsDigit( *c ); ++c )
+                value = FMath::Min( value * 10 + ( *c - '0' ), 10000 );
+            exponent += bNegativeExponent ? -value : value;
+        }
+        else
+        {
+            c = exponentStart; //Pas un exposant
+        }
+    }
+
+    //Jusqu'a 10^22 les puissances de 10 sont exactes en double : un seul arrondi, puis la conversion en float
+    //Une valeur ecrite avec 9 chiffres significatifs redonne exactement le meme float
+    auto value = static_cast< double >( mantissa );
+    for ( ; exponent < -22 && value != 0; exponent += 22 )
+        value /= PowersOf10[ 22 ];
+    for ( ; exponent > 22 && value != 0; exponent -= 22 )
+        value *= PowersOf10[ 22 ];
+    if ( exponent < 0 )
+        value /= PowersOf10[ -FMath::Max( exponent, -22 ) ];
+    else
+        value *= PowersOf10[ FMath::Min( exponent, 22 ) ];
+
+    return static_cast< float >( bNegative ? -value : value );
+}
+
+int32 FSWAttemptCsv::ParseLine( const ANSICHAR *& c, const ANSICHAR * end, float * values, const int32 maxValues, float * lastValue )
+{
+    auto nbValues = 0;
+    while ( true )
+    {
+        SkipSpaces( c, end );
+        if ( c == end || *c == '\n' )
+            break;
+
+        const auto value = ParseFloat( c, end );
+        if ( nbValues < maxValues )
+            values[ nbValues ] = value;
+        if ( lastValue != nullptr )
+            *lastValue = value;
+        nbValues++;
+
+        SkipSpaces( c, end );
+        if ( c < end && *c == ';' )
+            ++c;
+        else
+            break;
+    }
+
+    //Ce qui suit la derniere valeur est ignore
+    SkipLine( c, end );
+    return nbValues;
+}
+
+bool FSWAttemptCsv::IsDataLine( const ANSICHAR * c, const ANSICHAR * end )
+{
+    SkipSpaces( c, end );
+    return c < end && ( IsDigit( *c ) || *c == '-' || *c == '+' || *c == '.' );
+}
+
+void FSWAttemptCsv::ReadLast( const FString & fileName, const int nbLastAttempts, TFunctionRef< void( const float *, int32, float ) > onAttempt, const int nbSkipped )
+{
+    //Les lignes sautees sont lues mais pas converties
+    const auto nbLines = nbLastAttempts < 0 ? MAX_int32 - 1 : static_cast< int32 >( FMath::Min< int64 >( static_cast< int64 >( nbLastAttempts ) + nbSkipped, MAX_int32 - 1 ) );
+
+    //On ne lit que la fin du fichier : le temps de chargement depend de la fenetre, pas de l'historique du joueur
+    FTailReader tail( fileName );
+    auto nbNewLines = nbLines;
+
+    const ANSICHAR * first;
+    const ANSICHAR * last;
+    const ANSICHAR * end;
+    while ( true )
+    {
+        tail.ReadNewLines( nbNewLines );
+
+        const auto * begin = tail.Text.GetData();
+        end = begin + tail.Text.Num();
+
+        //On remonte depuis la fin jusqu'a la plus ancienne des nbLines dernieres lignes d'essai
+        //Les lignes vides et les headers (qui ne commencent pas par un nombre) ne comptent pas
+        //Sans le debut du fichier, la premiere ligne lue est incomplete : elle n'est jamais prise
+        first = end;
+        last = nbSkipped > 0 ? nullptr : end;
+        const auto * lineEnd = end;
+        auto nbFound = 0;
+        while ( nbFound < nbLines && lineEnd > begin )
+        {
+            const auto * lineStart = lineEnd;
+            while ( lineStart > begin && lineStart[ -1 ] != '\n' )
+                --lineStart;
+
+            if ( lineStart == begin && !tail.IsFromStart() )
+                break;
+
+            if ( IsDataLine( lineStart, lineEnd ) )
+            {
+                first = lineStart;
+                nbFound++;
+                //Les nbSkipped dernieres lignes d'essai commencent ici
+                if ( nbFound == nbSkipped )
+                    last = lineStart;
+            }
+
+            if ( lineStart == begin )
+                break;
+            lineEnd = lineStart - 1;
+        }
+
+        if ( nbFound >= nbLines || tail.IsFromStart() )
+            break;
+
+        //Des lignes vides ou des headers dans la fin lue : il manque des essais, on remonte plus loin
+        nbNewLines = FMath::Max( nbNewLines, tail.NbNewLines ) + ( nbLines - nbFound );
+    }
+
+    //Le fichier n'a pas plus de nbSkipped essais
+    if ( last == nullptr )
+        return;
+
+    //Un seul passage : les valeurs sont converties directement depuis le texte
+    TArray< float, TInlineAllocator< 9 > > values;
+    values.SetNumUninitialized( 9 );
+    for ( const auto * c = first; c < last; )
+    {
+        if ( !IsDataLine( c, last ) )
+        {
+            SkipLine( c, last );
+            continue;
+        }
+
+        const auto * lineStart = c;
+        const auto nbValues = ParseLine( c, last, values.GetData(), values.Num() );
+        if ( nbValues > values.Num() )
+        {
+            values.SetNumUninitialized( nbValues );
+            c = lineStart;
+            ParseLine( c, last, values.GetData(), values.Num() );
+        }
+
+        if ( nbValues >= 2 )
+            onAttempt( values.GetData(), nbValues - 1, values[ nbValues - 1 ] );
+    }
+}
+
+void FSWAttemptCsv::AppendLine( FString & content, const float * thetas, const int32 nbThetas, const float result )
+{
+    for ( auto i = 0; i < nbThetas; i++ )
+    {
+        content.Append( FString::SanitizeFloat( thetas[ i ] ) );
+        content.Append( ";" );
+    }
+    content.Append( FString::SanitizeFloat( result ) );
+    content.Append( "\n" );
+}
+
+bool FSWAttemptCsv::Save( const FString & fileName, const FSWAttemptsView & attempts )
+{
+    FString content;
+    for ( auto index = 0; index < attempts.Num(); ++index )
+    {
+        const auto * thetas = attempts.GetThetas( index );
+        for ( auto i = 0; i < attempts.NumThetas; i++ )
+        {
+            content.Append( FString::Printf( TEXT( "%.9g;" ), thetas[ i ] ) );
+        }
+        content.Append( FString::Printf( TEXT( "%.9g\n" ), attempts.GetResult( index ) ) );
+    }
+
+    return FFileHelper::SaveStringToFile( content, *fileName, FFileHelper::EEncodingOptions::ForceAnsi );
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+struct FSWAttemptsView;
+
+// Attempt files in CSV : thetas then result separated by ';', one attempt per line, the oldest first.
+// The first line can hold headers.
+struct SWARMS_API FSWAttemptCsv
+{
+    // Calls onAttempt( thetas, nbThetas, result ) for the nbLastAttempts last attempts of the file (all of them if nbLastAttempts < 0),
+    // oldest first, without the nbSkipped most recent ones. Only the end of the file is read. A missing file has no attempt
+    static void ReadLast( const FString & fileName, int nbLastAttempts, TFunctionRef< void( const float *, int32, float ) > onAttempt, int nbSkipped = 0 );
+
+    // Parses the ';' separated values of the line starting at c, straight from the text : at most maxValues are written in values.
+    // c is moved to the start of the next line. Returns the number of values of the line (can be more than maxValues).
+    // lastValue, if given, receives the last value of the line, even beyond maxValues
+    static int32 ParseLine( const ANSICHAR *& c, const ANSICHAR * end, float * values, int32 maxValues, float * lastValue = nullptr );
+
+    // Parses a float starting at c and moves c after it
+    static float ParseFloat( const ANSICHAR *& c, const ANSICHAR * end );
+
+    // True if the line starting at c starts with a number (not empty, not headers)
+    static bool IsDataLine( const ANSICHAR * c, const ANSICHAR * end );
+
+    // Line written by the data managers for each attempt
+    static void AppendLine( FString & content, const float * thetas, int32 nbThetas, float result );
+
+    // Replaces the file with these attempts. Values are written with 9 significant digits, so they are read back exactly
+    static bool Save( const FString & fileName, const FSWAttemptsView & attempts );
+};
@@ -0,0 +1,943 @@
+#include "SWAttemptLog.h"
+
+#include "SWAttemptStore.h"
+
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/Event.h>
+#include <HAL/PlatformFileManager.h>
+#include <HAL/PlatformProcess.h>
+#include <HAL/PlatformTime.h>
+#include <HAL/RunnableThread.h>
+#include <Misc/Crc.h>
+#include <Misc/FileHelper.h>
+#include <Misc/ScopeLock.h>
+
+namespace
+{
+    // Start of the index file, followed by NbKeys entries :
+    // Tail (int64), NbAttempts, NbThetas, the length of the UTF-8 player id and of the UTF-8 challenge id (int32), then both ids
+    struct FSWAttemptLogIndexHeader
+    {
+        static constexpr uint32 FileMagic = 0x494C5753; //"SWLI"
+        static constexpr uint16 CurrentVersion = 1;
+
+        uint32 Magic = FileMagic;
+        uint16 Version = CurrentVersion;
+        uint16 Flags = 0;
+        int32 NbKeys = 0;
+        int32 Generation = 0; //Changes each time the index is rewritten
+        int64 End = 0;        //Location after the last record known by the index
+    };
+
+    static_assert( sizeof( FSWAttemptLogIndexHeader ) == 24, "The header is written as is in the index file" );
+
+    // The journal is a sequence of commits : this header, then NbEntries entries of Size bytes in all.
+    // An entry is the KeyIndex (int32) followed by an index entry. The ids of a key already in the index are left empty
+    struct FSWAttemptLogJournalHeader
+    {
+        static constexpr uint32 CommitMagic = 0x4A4C5753; //"SWLJ"
+
+        uint32 Magic = CommitMagic;
+        int32 Generation = 0; //Of the index it completes
+        int32 NbEntries = 0;
+        uint32 Size = 0;
+        int64 End = 0;        //Location after the last record known by the commit
+        uint32 Crc = 0;       //Of the entries
+        uint32 Reserved = 0;
+    };
+
+    static_assert( sizeof( FSWAttemptLogJournalHeader ) == 32, "The header is written as is in the journal file" );
+
+    template< typename T >
+    void Write( TArray< uint8 > & data, const T & value )
+    {
+        data.Append( reinterpret_cast< const uint8 * >( &value ), sizeof( T ) );
+    }
+
+    template< typename T >
+    bool Read( const TArray< uint8 > & data, int64 & position, T & value )
+    {
+        if ( position + static_cast< int64 >( sizeof( T ) ) > data.Num() )
+            return false;
+
+        FMemory::Memcpy( &value, data.GetData() + position, sizeof( T ) );
+        position += sizeof( T );
+        return true;
+    }
+
+    FString FromUTF8( const uint8 * text, const int32 length )
+    {
+        const FUTF8ToTCHAR converted( reinterpret_cast< const ANSICHAR * >( text ), length );
+        return FString( converted.Length(), converted.Get() );
+    }
+
+    void WriteEntry( TArray< uint8 > & data, const int64 tail, const int32 nbAttempts, const int32 nbThetas, const FString & playerId, const FString & challengeId )
+    {
+        const FTCHARToUTF8 player( *playerId );
+        const FTCHARToUTF8 challenge( *challengeId );
+        Write( data, tail );
+        Write( data, nbAttempts );
+        Write( data, nbThetas );
+        Write( data, static_cast< int32 >( player.Length() ) );
+        Write( data, static_cast< int32 >( challenge.Length() ) );
+        data.Append( reinterpret_cast< const uint8 * >( player.Get() ), player.Length() );
+        data.Append( reinterpret_cast< const uint8 * >( challenge.Get() ), challenge.Length() );
+    }
+
+    bool ReadEntry( const TArray< uint8 > & data, int64 & position, int64 & tail, int32 & nbAttempts, int32 & nbThetas, FString & playerId, FString & challengeId )
+    {
+        int32 playerLength, challengeLength;
+        if ( !Read( data, position, tail ) || !Read( data, position, nbAttempts ) || !Read( data, position, nbThetas )
+            || !Read( data, position, playerLength ) || !Read( data, position, challengeLength )
+            || playerLength < 0 || challengeLength < 0 || position + playerLength + challengeLength > data.Num() )
+        {
+            return false;
+        }
+
+        playerId = FromUTF8( data.GetData() + position, playerLength );
+        challengeId = FromUTF8( data.GetData() + position + playerLength, challengeLength );
+        position += playerLength + challengeLength;
+        return true;
+    }
+
+    int32 GetSegment( const int64 location )
+    {
+        return static_cast< int32 >( location >> 32 );
+    }
+
+    int64 GetOffset( const int64 location )
+    {
+        return location & 0xFFFFFFFF;
+    }
+}
+
+// Keeps the handle of the segment being read, and gives it back to the log when the segment changes or the read ends
+class FSWAttemptLog::FSegmentReader
+{
+public:
+    explicit FSegmentReader( FSWAttemptLog & log )
+        : Log( log )
+    {
+    }
+
+    ~FSegmentReader()
+    {
+        if ( Handle )
+            Log.ReturnReadHandle( MoveTemp( Handle ) );
+    }
+
+    // The bytes from location, maxSize at most (less at the end of the segment)
+    const uint8 * Read( const int64 location, const int64 maxSize, int64 & size )
+    {
+        const auto segmentIndex = GetSegment( location );
+        if ( !Handle || Handle->Segment != segmentIndex )
+        {
+            if ( Handle )
+                Log.ReturnReadHandle( MoveTemp( Handle ) );
+            Handle = Log.CheckOutReadHandle( segmentIndex );
+            if ( !Handle )
+                return nullptr;
+        }
+
+        const auto offset = GetOffset( location );
+        if ( offset + maxSize > Handle->FileSize )
+            Handle->FileSize = Handle->File->Size();
+
+        size = FMath::Min( maxSize, Handle->FileSize - offset );
+        if ( size < static_cast< int64 >( sizeof( FSWAttemptLogRecordHeader ) ) )
+            return nullptr;
+
+        Data.SetNumUninitialized( size );
+        if ( !Handle->File->Seek( offset ) || !Handle->File->Read( Data.GetData(), size ) )
+            return nullptr;
+        return Data.GetData();
+    }
+
+private:
+    FSWAttemptLog & Log;
+    TUniquePtr< FReadHandle > Handle;
+    TArray< uint8 > Data;
+};
+
+FSWAttemptLog::FSWAttemptLog( const FString & directory, const int64 segmentMaxBytes, const int32 writeBufferBytes, const float flushSeconds, const float indexSaveSeconds )
+    : Directory( directory )
+    , SegmentMaxBytes( FMath::Clamp< int64 >( segmentMaxBytes, 4096, MAX_uint32 ) )
+    , WriteBufferBytes( FMath::Max( writeBufferBytes, 0 ) )
+    , FlushMilliseconds( static_cast< uint32 >( FMath::Max( flushSeconds, 0.001f ) * 1000 ) )
+    , IndexSaveSeconds( FMath::Max( indexSaveSeconds, 0.0f ) )
+{
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree( *Directory );
+
+    //Sans index valide (ou s'il ne correspond plus aux segments), on relit tous les segments
+    int64 end = -1;
+    if ( !LoadIndex( end ) || !Replay( end ) )
+    {
+        Keys.Reset();
+        KeyIndices.Reset();
+        IndexDirtyKeys.Reset();
+        Replay( -1 );
+        bCompactIndex = true;
+    }
+
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool( false );
+    Thread = FRunnableThread::Create( this, TEXT( "SWAttemptLog" ), 0, TPri_BelowNormal );
+}
+
+FSWAttemptLog::~FSWAttemptLog()
+{
+    if ( Thread != nullptr )
+    {
+        Thread->Kill( true );
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    Flush();
+
+    FPlatformProcess::ReturnSynchEventToPool( WakeEvent );
+    WakeEvent = nullptr;
+}
+
+FString FSWAttemptLog::GetIndexFileName( const FString & directory )
+{
+    return FPaths::Combine( directory, TEXT( "attempts.swi" ) );
+}
+
+FString FSWAttemptLog::GetJournalFileName( const FString & directory )
+{
+    return FPaths::Combine( directory, TEXT( "attempts.swj" ) );
+}
+
+FString FSWAttemptLog::GetSegmentFileName( const FString & directory, const int32 segmentIndex )
+{
+    return FPaths::Combine( directory, FString::Printf( TEXT( "attempts_%06d.swl" ), segmentIndex ) );
+}
+
+void FSWAttemptLog::Append( const FString & playerId, const FString & challengeId, const float * thetas, const int32 nbThetas, const float result )
+{
+    auto bWake = false;
+    {
+        FScopeLock lock( &Lock );
+
+        const auto * found = KeyIndices.Find( FSWCacheKey( playerId, challengeId ) );
+        const auto keyIndex = found != nullptr ? *found : AddKey( playerId, challengeId, true );
+        auto & entry = Keys[ keyIndex ];
+
+        //Un bloc ne melange pas les nombres de thetas : les essais d'avant restent un par un
+        if ( entry.NbThetas != nbThetas )
+            FreeOpenBlock( entry );
+
+        entry.NbAttempts++;
+        entry.NbThetas = nbThetas;
+        entry.LastAppend = ++NbAppends;
+
+        FSWAttemptLogRecordHeader header;
+        header.Previous = entry.Tail;
+        header.KeyIndex = keyIndex;
+        header.Type = FSWAttemptLogRecordHeader::TypeAttempt;
+        header.NbThetas = static_cast< uint16 >( nbThetas );
+        header.Size = ( nbThetas + 1 ) * sizeof( float );
+        header.Total = entry.NbAttempts;
+
+        //Les thetas puis le resultat, contigus
+        TArray< float, TInlineAllocator< 16 > > payload;
+        payload.Append( thetas, nbThetas );
+        payload.Add( result );
+
+        if ( entry.OpenBlock.Num() == 0 )
+            entry.OpenPrevious = entry.Tail;
+        entry.Tail = AppendRecord( header, payload.GetData() );
+        entry.OpenBlock.Append( payload.GetData(), payload.Num() );
+        OpenBlocksBytes += payload.Num() * sizeof( float );
+
+        if ( entry.OpenBlock.Num() == BlockMaxAttempts * payload.Num() )
+        {
+            //Les essais du bloc en un seul record : il les remplace dans la chaine, une lecture au lieu de BlockMaxAttempts
+            header.Previous = entry.OpenPrevious;
+            header.Type = FSWAttemptLogRecordHeader::TypeBlock;
+            header.Size = entry.OpenBlock.Num() * sizeof( float );
+            entry.Tail = AppendRecord( header, entry.OpenBlock.GetData() );
+            FreeOpenBlock( entry );
+        }
+        else if ( OpenBlocksBytes > OpenBlocksMaxBytes )
+        {
+            TrimOpenBlocks();
+        }
+
+        bWake = Chunks.Last()->Data.Num() >= WriteBufferBytes;
+    }
+
+    if ( bWake )
+        WakeEvent->Trigger();
+}
+
+void FSWAttemptLog::ReadLast( const FString & playerId, const FString & challengeId, const int nbLastAttempts, FSWAttemptStore & attempts, const int nbSkipped )
+{
+    attempts.Reset();
+
+    //Records du plus recent au plus ancien, chacun avec ses essais du plus ancien au plus recent
+    TArray< TArray< float > > records;
+    auto nbRead = 0;
+    const auto nbWanted = nbLastAttempts < 0 ? MAX_int64 : static_cast< int64 >( nbLastAttempts ) + FMath::Max( nbSkipped, 0 );
+
+    int32 keyIndex;
+    int32 nbThetas;
+    int64 tail;
+    int64 location;
+
+    //Essais isoles en bout de chaine (laisses par un redemarrage) : si on les lit tous, le prochain bloc les reprend
+    auto bCountSingles = false;
+    auto nbSingles = 0;
+    auto bOtherThetas = false;
+    auto bEnd = false;
+
+    const auto addRecord = [&]( const uint8 * data, const int64 size )
+    {
+        FSWAttemptLogRecordHeader header;
+        if ( data == nullptr || size < static_cast< int64 >( sizeof( header ) ) )
+            return false;
+
+        FMemory::Memcpy( &header, data, sizeof( header ) );
+        const auto recordSize = static_cast< uint32 >( ( nbThetas + 1 ) * sizeof( float ) );
+        if ( ( header.Type != FSWAttemptLogRecordHeader::TypeAttempt && header.Type != FSWAttemptLogRecordHeader::TypeBlock ) || header.KeyIndex != keyIndex
+            || header.Size == 0 || header.Size % recordSize != 0 || static_cast< int64 >( sizeof( header ) ) + header.Size > size )
+        {
+            return false;
+        }
+
+        //Nombre de thetas different : on ne garde que les plus recents
+        if ( header.NbThetas != nbThetas )
+        {
+            bOtherThetas = true;
+            return false;
+        }
+
+        if ( bCountSingles && header.Type == FSWAttemptLogRecordHeader::TypeAttempt )
+            nbSingles++;
+        else
+            bCountSingles = false;
+
+        auto & values = records.AddDefaulted_GetRef();
+        values.SetNumUninitialized( header.Size / sizeof( float ) );
+        FMemory::Memcpy( values.GetData(), data + sizeof( header ), header.Size );
+        nbRead += header.Size / recordSize;
+        location = header.Previous;
+        return true;
+    };
+
+    {
+        //Sous le verrou, seulement des copies en memoire : les essais pas encore dans un bloc et les records pas encore ecrits
+        FScopeLock lock( &Lock );
+
+        const auto * found = KeyIndices.Find( FSWCacheKey( playerId, challengeId ) );
+        if ( found == nullptr )
+            return;
+
+        keyIndex = *found;
+        const auto & entry = Keys[ keyIndex ];
+        nbThetas = entry.NbThetas;
+        tail = location = entry.Tail;
+
+        if ( entry.OpenBlock.Num() > 0 )
+        {
+            records.Add( entry.OpenBlock );
+            nbRead += entry.OpenBlock.Num() / ( nbThetas + 1 );
+            location = entry.OpenPrevious;
+        }
+        else
+        {
+            bCountSingles = true;
+        }
+
+        int64 size;
+        const uint8 * pending;
+        while ( nbRead < nbWanted && location >= 0 && ( pending = FindPending( location, size ) ) != nullptr )
+        {
+            if ( !addRecord( pending, size ) )
+            {
+                bEnd = true;
+                break;
+            }
+        }
+    }
+
+    //Le reste est dans les segments : lu sans verrou, ils ne changent plus
+    const auto maxRecordSize = static_cast< int64 >( sizeof( FSWAttemptLogRecordHeader ) ) + BlockMaxAttempts * ( nbThetas + 1 ) * sizeof( float );
+    FSegmentReader reader( *this );
+    while ( !bEnd && nbRead < nbWanted && location >= 0 )
+    {
+        int64 size = 0;
+        const auto * data = reader.Read( location, maxRecordSize, size );
+        if ( !addRecord( data, size ) )
+            break;
+    }
+
+    if ( bCountSingles && nbSingles > 0 && nbSingles < BlockMaxAttempts && ( location < 0 || bOtherThetas ) )
+    {
+        FScopeLock lock( &Lock );
+
+        auto & entry = Keys[ keyIndex ];
+        if ( entry.Tail == tail && entry.OpenBlock.Num() == 0 && entry.NbThetas == nbThetas )
+        {
+            for ( auto index = nbSingles - 1; index >= 0; --index )
+                entry.OpenBlock.Append( records[ index ] );
+            entry.OpenPrevious = location;
+            OpenBlocksBytes += entry.OpenBlock.Num() * sizeof( float );
+            if ( OpenBlocksBytes > OpenBlocksMaxBytes )
+                TrimOpenBlocks();
+        }
+    }
+
+    //On saute les nbSkipped plus recents, et les plus anciens au-dela de la fenetre
+    const auto nbKept = static_cast< int32 >( FMath::Clamp< int64 >( nbRead - FMath::Max( nbSkipped, 0 ), 0, nbLastAttempts < 0 ? MAX_int32 : nbLastAttempts ) );
+    auto nbToDrop = nbRead - FMath::Max( nbSkipped, 0 ) - nbKept;
+
+    attempts.NumThetas = nbThetas;
+    attempts.Results.Reserve( nbKept );
+    attempts.Thetas.Reserve( nbKept * nbThetas );
+    for ( auto index = records.Num() - 1; index >= 0 && attempts.Num() < nbKept; --index )
+    {
+        const auto & values = records[ index ];
+        for ( auto position = 0; position < values.Num() && attempts.Num() < nbKept; position += nbThetas + 1 )
+        {
+            if ( nbToDrop > 0 )
+            {
+                nbToDrop--;
+                continue;
+            }
+
+            attempts.Thetas.Append( values.GetData() + position, nbThetas );
+            attempts.Results.Add( values[ position + nbThetas ] );
+        }
+    }
+}
+
+int32 FSWAttemptLog::Num( const FString & playerId, const FString & challengeId ) const
+{
+    FScopeLock lock( &Lock );
+
+    const auto * found = KeyIndices.Find( FSWCacheKey( playerId, challengeId ) );
+    return found != nullptr ? Keys[ *found ].NbAttempts : 0;
+}
+
+void FSWAttemptLog::Flush()
+{
+    WritePending( true );
+}
+
+uint32 FSWAttemptLog::Run()
+{
+    auto lastIndexSave = FPlatformTime::Seconds();
+    while ( !bStopping )
+    {
+        //Reveille par Append quand WriteBufferBytes attendent, sinon toutes les FlushMilliseconds
+        WakeEvent->Wait( FlushMilliseconds );
+
+        //L'index est aussi sauve ici (un commit du journal, peu couteux) : un serveur qui ne change jamais de niveau
+        //ne rejoue pas tous ses segments apres un crash
+        const auto now = FPlatformTime::Seconds();
+        const auto bSaveIndex = now - lastIndexSave >= IndexSaveSeconds;
+        if ( bSaveIndex )
+            lastIndexSave = now;
+        WritePending( bSaveIndex );
+    }
+
+    return 0;
+}
+
+void FSWAttemptLog::Stop()
+{
+    bStopping = true;
+    WakeEvent->Trigger();
+}
+
+TUniquePtr< FSWAttemptLog::FReadHandle > FSWAttemptLog::CheckOutReadHandle( const int32 segmentIndex )
+{
+    {
+        FScopeLock lock( &ReadHandlesLock );
+        for ( auto index = ReadHandles.Num() - 1; index >= 0; --index )
+        {
+            if ( ReadHandles[ index ]->Segment == segmentIndex )
+            {
+                auto handle = MoveTemp( ReadHandles[ index ] );
+                ReadHandles.RemoveAt( index );
+                return handle;
+            }
+        }
+    }
+
+    //Aucun libre : ouvert hors du verrou, il rejoindra les autres quand il sera rendu
+    auto handle = MakeUnique< FReadHandle >();
+    handle->File.Reset( FPlatformFileManager::Get().GetPlatformFile().OpenRead( *GetSegmentFileName( Directory, segmentIndex ) ) );
+    if ( !handle->File )
+        return nullptr;
+
+    handle->Segment = segmentIndex;
+    handle->FileSize = handle->File->Size();
+    return handle;
+}
+
+void FSWAttemptLog::ReturnReadHandle( TUniquePtr< FReadHandle > handle )
+{
+    FScopeLock lock( &ReadHandlesLock );
+    if ( ReadHandles.Num() >= MaxReadHandles )
+        ReadHandles.RemoveAt( 0 );
+    ReadHandles.Add( MoveTemp( handle ) );
+}
+
+void FSWAttemptLog::WritePending( const bool bSaveIndex )
+{
+    FScopeLock writeLock( &WriteLock );
+
+    TArray< FChunk * > chunks;
+    TArray< uint8 > index;
+    auto bSnapshot = false;
+    {
+        //Les chunks scelles ne changent plus : ils sont ecrits hors du verrou, Append en commence un nouveau
+        FScopeLock lock( &Lock );
+        for ( auto & chunk : Chunks )
+        {
+            chunk->bSealed = true;
+            chunks.Add( chunk.Get() );
+        }
+
+        //L'index ne parle que des records scelles
+        if ( bSaveIndex )
+            BuildIndexChanges( index, bSnapshot );
+    }
+
+    auto nbWritten = 0;
+    for ( const auto * chunk : chunks )
+    {
+        if ( !WriteHandle || chunk->Segment != WriteSegment )
+        {
+            WriteHandle.Reset( FPlatformFileManager::Get().GetPlatformFile().OpenWrite( *GetSegmentFileName( Directory, chunk->Segment ), true, true ) );
+            WriteSegment = chunk->Segment;
+        }
+
+        //Sans fichier, le chunk est garde pour la prochaine ecriture
+        if ( !WriteHandle || !WriteHandle->Write( chunk->Data.GetData(), chunk->Data.Num() ) )
+        {
+            WriteHandle.Reset();
+            break;
+        }
+
+        WriteHandle->Flush();
+        nbWritten++;
+    }
+
+    {
+        //Ecrits : les lectures les trouvent maintenant dans les segments
+        FScopeLock lock( &Lock );
+        Chunks.RemoveAt( 0, nbWritten );
+    }
+
+    if ( nbWritten < chunks.Num() )
+        bCompactIndex = bCompactIndex || index.Num() > 0;
+    else if ( index.Num() > 0 )
+        SaveIndex( index, bSnapshot );
+}
+
+bool FSWAttemptLog::LoadIndex( int64 & end )
+{
+    TArray< uint8 > data;
+    if ( !FFileHelper::LoadFileToArray( data, *GetIndexFileName( Directory ) ) )
+        return false;
+
+    int64 position = 0;
+    FSWAttemptLogIndexHeader header;
+    if ( !Read( data, position, header ) || header.Magic != FSWAttemptLogIndexHeader::FileMagic
+        || header.Version != FSWAttemptLogIndexHeader::CurrentVersion || header.NbKeys < 0 )
+    {
+        return false;
+    }
+
+    for ( auto keyIndex = 0; keyIndex < header.NbKeys; ++keyIndex )
+    {
+        FKeyEntry entry;
+        if ( !ReadEntry( data, position, entry.Tail, entry.NbAttempts, entry.NbThetas, entry.PlayerId, entry.ChallengeId ) )
+            return false;
+
+        KeyIndices.Add( FSWCacheKey( entry.PlayerId, entry.ChallengeId ), keyIndex );
+        Keys.Add( MoveTemp( entry ) );
+    }
+
+    IndexGeneration = header.Generation;
+    IndexBytes = data.Num();
+    end = header.End;
+    return LoadJournal( end );
+}
+
+bool FSWAttemptLog::LoadJournal( int64 & end )
+{
+    TArray< uint8 > data;
+    if ( !FFileHelper::LoadFileToArray( data, *GetJournalFileName( Directory ) ) )
+        return true;
+
+    JournalBytes = data.Num();
+
+    int64 position = 0;
+    FSWAttemptLogJournalHeader header;
+    while ( Read( data, position, header ) )
+    {
+        //Commit a moitie ecrit (arret brutal) : les records qui le suivent sont rejoues
+        if ( header.Magic != FSWAttemptLogJournalHeader::CommitMagic || position + header.Size > data.Num()
+            || header.Crc != FCrc::MemCrc32( data.GetData() + position, header.Size ) )
+        {
+            bCompactIndex = true;
+            return true;
+        }
+
+        //D'un index precedent, remplace avant que le journal ait pu etre efface
+        if ( header.Generation != IndexGeneration )
+        {
+            bCompactIndex = true;
+            position += header.Size;
+            continue;
+        }
+
+        for ( auto index = 0; index < header.NbEntries; ++index )
+        {
+            int32 keyIndex;
+            FKeyEntry entry;
+            if ( !Read( data, position, keyIndex ) || keyIndex < 0 || keyIndex > Keys.Num()
+                || !ReadEntry( data, position, entry.Tail, entry.NbAttempts, entry.NbThetas, entry.PlayerId, entry.ChallengeId ) )
+            {
+                return false;
+            }
+
+            if ( keyIndex == Keys.Num() )
+            {
+                KeyIndices.Add( FSWCacheKey( entry.PlayerId, entry.ChallengeId ), keyIndex );
+                Keys.Add( MoveTemp( entry ) );
+            }
+            else
+            {
+                auto & known = Keys[ keyIndex ];
+                known.Tail = entry.Tail;
+                known.NbAttempts = entry.NbAttempts;
+                known.NbThetas = entry.NbThetas;
+            }
+        }
+
+        end = header.End;
+    }
+
+    bCompactIndex = bCompactIndex || position != data.Num();
+    return true;
+}
+
+void FSWAttemptLog::BuildIndexChanges( TArray< uint8 > & data, bool & bSnapshot )
+{
+    //Le journal est fusionne dans un nouvel index quand il devient plus grand que lui
+    bSnapshot = bCompactIndex || JournalBytes > IndexBytes;
+    if ( !bSnapshot && IndexDirtyKeys.Num() == 0 )
+        return;
+
+    const auto end = MakeLocation( ActiveSegment, ActiveSize );
+    if ( bSnapshot )
+    {
+        FSWAttemptLogIndexHeader header;
+        header.NbKeys = Keys.Num();
+        header.Generation = IndexGeneration + 1;
+        header.End = end;
+
+        Write( data, header );
+        for ( auto & entry : Keys )
+        {
+            WriteEntry( data, entry.Tail, entry.NbAttempts, entry.NbThetas, entry.PlayerId, entry.ChallengeId );
+            entry.bIndexDirty = false;
+            entry.bIndexNew = false;
+        }
+    }
+    else
+    {
+        FSWAttemptLogJournalHeader header;
+        header.Generation = IndexGeneration;
+        header.NbEntries = IndexDirtyKeys.Num();
+        header.End = end;
+
+        //Seules les cles changees, et les ids des nouvelles
+        Write( data, header );
+        for ( const auto keyIndex : IndexDirtyKeys )
+        {
+            auto & entry = Keys[ keyIndex ];
+            Write( data, keyIndex );
+            WriteEntry( data, entry.Tail, entry.NbAttempts, entry.NbThetas, entry.bIndexNew ? entry.PlayerId : FString(), entry.bIndexNew ? entry.ChallengeId : FString() );
+            entry.bIndexDirty = false;
+            entry.bIndexNew = false;
+        }
+
+        const auto entriesSize = data.Num() - static_cast< int32 >( sizeof( header ) );
+        header.Size = entriesSize;
+        header.Crc = FCrc::MemCrc32( data.GetData() + sizeof( header ), entriesSize );
+        FMemory::Memcpy( data.GetData(), &header, sizeof( header ) );
+    }
+
+    IndexDirtyKeys.Reset();
+}
+
+void FSWAttemptLog::SaveIndex( const TArray< uint8 > & data, const bool bSnapshot )
+{
+    auto & platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const auto journalFileName = GetJournalFileName( Directory );
+
+    if ( !bSnapshot )
+    {
+        //Les changements a la suite du journal : le cout ne depend pas du nombre de cles
+        TUniquePtr< IFileHandle > journal( platformFile.OpenWrite( *journalFileName, true, true ) );
+        if ( journal && journal->Write( data.GetData(), data.Num() ) && journal->Flush() )
+            JournalBytes += data.Num();
+        else
+            bCompactIndex = true;
+        return;
+    }
+
+    //Ecrit a cote puis renomme : un index a moitie ecrit ne remplace jamais le precedent
+    const auto fileName = GetIndexFileName( Directory );
+    const auto tempFileName = fileName + TEXT( ".tmp" );
+    if ( FFileHelper::SaveArrayToFile( data, *tempFileName ) )
+    {
+        platformFile.DeleteFile( *fileName );
+        bCompactIndex = !platformFile.MoveFile( *fileName, *tempFileName );
+    }
+    else
+    {
+        bCompactIndex = true;
+    }
+
+    if ( !bCompactIndex )
+    {
+        //Les entrees de l'ancien journal sont dans le nouvel index, et d'une autre generation s'il n'est pas efface
+        IndexGeneration++;
+        IndexBytes = data.Num();
+        JournalBytes = 0;
+        platformFile.DeleteFile( *journalFileName );
+    }
+}
+
+bool FSWAttemptLog::Replay( const int64 end )
+{
+    const auto firstSegment = end < 0 ? 0 : GetSegment( end );
+    const auto firstOffset = end < 0 ? 0 : GetOffset( end );
+
+    auto & platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    auto lastSegment = -1;
+    int64 lastSize = 0;
+    auto bIncomplete = false;
+    TArray< uint8 > data;
+
+    for ( auto segmentIndex = firstSegment; ; ++segmentIndex )
+    {
+        TUniquePtr< IFileHandle > file( platformFile.OpenRead( *GetSegmentFileName( Directory, segmentIndex ) ) );
+        if ( !file )
+            break;
+
+        const auto size = file->Size();
+        auto from = segmentIndex == firstSegment ? firstOffset : 0;
+        if ( from > size )
+            return false;
+
+        lastSegment = segmentIndex;
+        lastSize = size;
+        bIncomplete = false;
+
+        if ( from < static_cast< int64 >( sizeof( FSWAttemptLogSegmentHeader ) ) )
+        {
+            FSWAttemptLogSegmentHeader segmentHeader;
+            if ( !file->Read( reinterpret_cast< uint8 * >( &segmentHeader ), sizeof( segmentHeader ) ) || !segmentHeader.IsValid() )
+            {
+                bIncomplete = true;
+                continue;
+            }
+            from = sizeof( segmentHeader );
+        }
+
+        data.SetNumUninitialized( size - from );
+        if ( !file->Seek( from ) || !file->Read( data.GetData(), data.Num() ) )
+        {
+            bIncomplete = true;
+            continue;
+        }
+
+        int64 position = 0;
+        while ( position < data.Num() )
+        {
+            const auto location = MakeLocation( segmentIndex, from + position );
+            FSWAttemptLogRecordHeader header;
+            if ( !Read( data, position, header ) || position + header.Size > data.Num() )
+            {
+                bIncomplete = true;
+                break;
+            }
+
+            const auto * payload = data.GetData() + position;
+            position += header.Size;
+
+            const auto recordSize = ( header.NbThetas + 1 ) * sizeof( float );
+            if ( header.Type == FSWAttemptLogRecordHeader::TypeKey && header.KeyIndex <= Keys.Num() )
+            {
+                //Deja dans l'index si KeyIndex < Keys.Num()
+                if ( header.KeyIndex == Keys.Num() )
+                {
+                    auto playerLength = 0;
+                    while ( playerLength < static_cast< int32 >( header.Size ) && payload[ playerLength ] != 0 )
+                        playerLength++;
+
+                    const auto challengeLength = FMath::Max( static_cast< int32 >( header.Size ) - playerLength - 1, 0 );
+                    AddKey( FromUTF8( payload, playerLength ), FromUTF8( payload + playerLength + 1, challengeLength ), false );
+                }
+            }
+            else if ( ( ( header.Type == FSWAttemptLogRecordHeader::TypeAttempt && header.Size == recordSize )
+                    || ( header.Type == FSWAttemptLogRecordHeader::TypeBlock && header.Size > 0 && header.Size % recordSize == 0 ) )
+                && header.KeyIndex >= 0 && header.KeyIndex < Keys.Num() )
+            {
+                //Total rend la relecture sans effet sur ce que l'index connait deja. Les anciens logs n'ont que des essais isoles
+                auto & entry = Keys[ header.KeyIndex ];
+                entry.Tail = location;
+                entry.NbAttempts = header.Total > 0 ? static_cast< int32 >( header.Total ) : entry.NbAttempts + 1;
+                entry.NbThetas = header.NbThetas;
+                MarkIndexDirty( header.KeyIndex );
+            }
+            else
+            {
+                //Record a moitie ecrit (arret brutal) : la suite du segment est ignoree
+                bIncomplete = true;
+                break;
+            }
+        }
+    }
+
+    if ( lastSegment < 0 )
+    {
+        //Le segment courant de l'index n'existe que s'il a ete ecrit
+        if ( end >= 0 && firstOffset > 0 )
+            return false;
+
+        StartSegment( firstSegment );
+        return true;
+    }
+
+    //On n'ecrit jamais apres un record incomplet
+    ActiveSegment = lastSegment;
+    ActiveSize = lastSize;
+    if ( bIncomplete || lastSize >= SegmentMaxBytes )
+        StartSegment( lastSegment + 1 );
+
+    return true;
+}
+
+int32 FSWAttemptLog::AddKey( const FString & playerId, const FString & challengeId, const bool bWriteRecord )
+{
+    const auto keyIndex = Keys.Num();
+    auto & entry = Keys.AddDefaulted_GetRef();
+    entry.PlayerId = playerId;
+    entry.ChallengeId = challengeId;
+    entry.bIndexNew = true;
+    KeyIndices.Add( FSWCacheKey( playerId, challengeId ), keyIndex );
+    MarkIndexDirty( keyIndex );
+
+    if ( bWriteRecord )
+    {
+        //Le nom de la cle est dans le log : il est retrouve meme si l'index n'a pas ete sauve
+        const FTCHARToUTF8 player( *playerId );
+        const FTCHARToUTF8 challenge( *challengeId );
+        TArray< uint8 > payload;
+        payload.Append( reinterpret_cast< const uint8 * >( player.Get() ), player.Length() );
+        payload.Add( 0 );
+        payload.Append( reinterpret_cast< const uint8 * >( challenge.Get() ), challenge.Length() );
+
+        FSWAttemptLogRecordHeader header;
+        header.KeyIndex = keyIndex;
+        header.Type = FSWAttemptLogRecordHeader::TypeKey;
+        header.Size = payload.Num();
+        AppendRecord( header, payload.GetData() );
+    }
+
+    return keyIndex;
+}
+
+void FSWAttemptLog::MarkIndexDirty( const int32 keyIndex )
+{
+    auto & entry = Keys[ keyIndex ];
+    if ( !entry.bIndexDirty )
+    {
+        entry.bIndexDirty = true;
+        IndexDirtyKeys.Add( keyIndex );
+    }
+}
+
+void FSWAttemptLog::StartSegment( const int32 segmentIndex )
+{
+    ActiveSegment = segmentIndex;
+    ActiveSize = 0;
+
+    FSWAttemptLogSegmentHeader header;
+    header.SegmentIndex = segmentIndex;
+    AppendBytes( &header, sizeof( header ) );
+}
+
+int64 FSWAttemptLog::AppendRecord( const FSWAttemptLogRecordHeader & header, const void * payload )
+{
+    const auto recordSize = static_cast< int64 >( sizeof( header ) ) + header.Size;
+    if ( ActiveSize + recordSize > SegmentMaxBytes && ActiveSize > static_cast< int64 >( sizeof( FSWAttemptLogSegmentHeader ) ) )
+        StartSegment( ActiveSegment + 1 );
+
+    const auto location = MakeLocation( ActiveSegment, ActiveSize );
+    AppendBytes( &header, sizeof( header ) );
+    AppendBytes( payload, header.Size );
+    MarkIndexDirty( header.KeyIndex );
+    return location;
+}
+
+void FSWAttemptLog::AppendBytes( const void * data, const int64 size )
+{
+    if ( Chunks.Num() == 0 || Chunks.Last()->bSealed || Chunks.Last()->Segment != ActiveSegment )
+    {
+        auto & chunk = *Chunks.Add_GetRef( MakeUnique< FChunk >() );
+        chunk.Segment = ActiveSegment;
+        chunk.Offset = ActiveSize;
+    }
+
+    Chunks.Last()->Data.Append( static_cast< const uint8 * >( data ), size );
+    ActiveSize += size;
+}
+
+const uint8 * FSWAttemptLog::FindPending( const int64 location, int64 & size ) const
+{
+    //Peu de chunks : ceux que le thread est en train d'ecrire, et le courant
+    const auto segmentIndex = GetSegment( location );
+    const auto offset = GetOffset( location );
+    for ( const auto & chunk : Chunks )
+    {
+        const auto position = offset - chunk->Offset;
+        if ( chunk->Segment == segmentIndex && position >= 0 && position < chunk->Data.Num() )
+        {
+            size = chunk->Data.Num() - position;
+            return chunk->Data.GetData() + position;
+        }
+    }
+
+    return nullptr;
+}
+
+void FSWAttemptLog::FreeOpenBlock( FKeyEntry & entry )
+{
+    OpenBlocksBytes -= entry.OpenBlock.Num() * sizeof( float );
+    entry.OpenBlock.Empty();
+}
+
+void FSWAttemptLog::TrimOpenBlocks()
+{
+    //On libere jusqu'aux trois quarts du budget, pour ne pas recommencer a chaque essai
+    TArray< int32 > open;
+    for ( auto keyIndex = 0; keyIndex < Keys.Num(); ++keyIndex )
+    {
+        if ( Keys[ keyIndex ].OpenBlock.Num() > 0 )
+            open.Add( keyIndex );
+    }
+
+    open.Sort( [this]( const int32 a, const int32 b ) { return Keys[ a ].LastAppend < Keys[ b ].LastAppend; } );
+    for ( auto index = 0; index < open.Num() && OpenBlocksBytes > OpenBlocksMaxBytes * 3 / 4; ++index )
+        FreeOpenBlock( Keys[ open[ index ] ] );
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <HAL/Runnable.h>
+
+#include "SWCacheData.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+class IFileHandle;
+struct FSWAttemptStore;
+
+// Start of every segment file
+struct FSWAttemptLogSegmentHeader
+{
+    static constexpr uint32 FileMagic = 0x474C5753; //"SWLG"
+    static constexpr uint16 CurrentVersion = 1;
+
+    uint32 Magic = FileMagic;
+    uint16 Version = CurrentVersion;
+    uint16 Flags = 0;
+    int32 SegmentIndex = 0;
+    int32 Reserved = 0;
+
+    bool IsValid() const
+    {
+        return Magic == FileMagic && Version == CurrentVersion;
+    }
+};
+
+static_assert( sizeof( FSWAttemptLogSegmentHeader ) == 16, "The header is written as is in the segment files" );
+
+// Every record of a segment starts with this header, followed by Size bytes :
+// - attempt : NbThetas floats then the result (float). Previous is the location of the previous record of the same key (-1 for the first one)
+// - block : BlockMaxAttempts consecutive attempts of the same key, oldest first, each one written as in an attempt record.
+//   They were first written one by one : the block replaces them in the chain, its Previous is the record before the oldest one
+// - key : the UTF-8 player id, a 0, then the UTF-8 challenge id. KeyIndex is the index given to this player and challenge
+// Total is the number of attempts of the key up to the last one of the record (0 in the logs written before the blocks).
+// A location is the segment index in the high 32 bits and the offset in the segment in the low 32 bits
+struct FSWAttemptLogRecordHeader
+{
+    enum : uint16
+    {
+        TypeAttempt = 1,
+        TypeKey = 2,
+        TypeBlock = 3
+    };
+
+    int64 Previous = -1;
+    int32 KeyIndex = 0;
+    uint32 Size = 0;
+    uint16 Type = 0;
+    uint16 NbThetas = 0;
+    uint32 Total = 0;
+};
+
+static_assert( sizeof( FSWAttemptLogRecordHeader ) == 24, "The header is written as is in the segment files" );
+
+// Attempts of every player and challenge, appended to a few large segment files in one directory instead of one file per pair.
+// Each record points back to the previous record of the same player and challenge : the last attempts are found by following
+// this chain from the most recent one. Every BlockMaxAttempts attempts of a player and challenge are also written together
+// in a block record, so that reading a window takes about one read per BlockMaxAttempts attempts.
+// The end of each chain is kept in an index (attempts.swi). Flush appends the entries changed since the previous Flush
+// to a journal (attempts.swj), merged into a new index once it is larger than it. The background thread also saves them
+// every indexSaveSeconds.
+// Records appended after the last saved index are replayed when the log is opened, so nothing is lost if Flush was not called.
+// Append only copies the records in memory : a background thread writes them once writeBufferBytes are waiting,
+// or flushSeconds after the previous write. No lock is held while a file is read or written.
+// The segments are read through a few handles kept open, each one used by one ReadLast at a time.
+// All the methods can be called from any thread.
+class SWARMS_API FSWAttemptLog : public FRunnable
+{
+public:
+    static constexpr int64 DefaultSegmentMaxBytes = 256 * 1024 * 1024;
+    static constexpr int32 DefaultWriteBufferBytes = 64 * 1024;
+    static constexpr float DefaultFlushSeconds = 2.0f;
+    static constexpr float DefaultIndexSaveSeconds = 30.0f;
+    static constexpr int32 MaxReadHandles = 16;
+    static constexpr int32 BlockMaxAttempts = 32;
+    // Memory of the attempts not in a block yet. Beyond it, the players and challenges without attempt for the longest time
+    // give theirs up : they stay in the chain one by one
+    static constexpr int64 OpenBlocksMaxBytes = 32 * 1024 * 1024;
+
+    // Opens the log of directory (created if needed), loads its index and starts the writing thread
+    explicit FSWAttemptLog( const FString & directory, int64 segmentMaxBytes = DefaultSegmentMaxBytes, int32 writeBufferBytes = DefaultWriteBufferBytes,
+        float flushSeconds = DefaultFlushSeconds, float indexSaveSeconds = DefaultIndexSaveSeconds );
+    // Stops the thread, then Flush
+    virtual ~FSWAttemptLog();
+
+    // Never touches the file system : the attempt is written by the background thread
+    void Append( const FString & playerId, const FString & challengeId, const float * thetas, int32 nbThetas, float result );
+
+    // The nbLastAttempts last attempts of this player for this challenge (all of them if nbLastAttempts < 0), oldest first,
+    // without the nbSkipped most recent ones. If their number of thetas changed, only the attempts with the most recent number of thetas are returned
+    void ReadLast( const FString & playerId, const FString & challengeId, int nbLastAttempts, FSWAttemptStore & attempts, int nbSkipped = 0 );
+
+    // Number of attempts saved for this player and challenge
+    int32 Num( const FString & playerId, const FString & challengeId ) const;
+
+    // Writes everything appended before returning, then saves the changes of the index
+    void Flush();
+
+    static FString GetIndexFileName( const FString & directory );
+    static FString GetJournalFileName( const FString & directory );
+    static FString GetSegmentFileName( const FString & directory, int32 segmentIndex );
+
+    // FRunnable
+    uint32 Run() override;
+    void Stop() override;
+
+private:
+    struct FKeyEntry
+    {
+        FString PlayerId;
+        FString ChallengeId;
+        int64 Tail = -1;     //Location of the most recent record
+        int32 NbAttempts = 0;
+        int32 NbThetas = 0;  //Of the most recent attempt
+        //Essais ecrits un par un depuis le dernier bloc, recopies dans le suivant
+        TArray< float > OpenBlock;
+        int64 OpenPrevious = -1; //Record precedant le plus ancien essai de OpenBlock
+        uint64 LastAppend = 0;
+        bool bIndexDirty = false; //Change depuis la derniere sauvegarde de l'index
+        bool bIndexNew = false;   //Absent de l'index sauve : ses ids sont ecrits avec lui
+    };
+
+    // Bytes of a segment, from Offset, not written yet. Only the last chunk, if it is not sealed, is still appended to
+    struct FChunk
+    {
+        int32 Segment = 0;
+        int64 Offset = 0;
+        TArray< uint8 > Data;
+        bool bSealed = false;
+    };
+
+    // Segment open for reading, in ReadHandles when no ReadLast uses it
+    struct FReadHandle
+    {
+        int32 Segment = -1;
+        TUniquePtr< IFileHandle > File;
+        int64 FileSize = 0; //Relue quand un record semble depasser la fin : le segment courant grandit
+    };
+
+    // Records read by one ReadLast, through handles borrowed from ReadHandles
+    class FSegmentReader;
+
+    // A free handle of segmentIndex, or a new one (nullptr if the segment cannot be opened)
+    TUniquePtr< FReadHandle > CheckOutReadHandle( int32 segmentIndex );
+    void ReturnReadHandle( TUniquePtr< FReadHandle > handle );
+
+    bool LoadIndex( int64 & end );
+    // Applies the journal entries of the loaded index
+    bool LoadJournal( int64 & end );
+    // Under Lock : the entries changed since the last save, or the whole index if bSnapshot
+    void BuildIndexChanges( TArray< uint8 > & data, bool & bSnapshot );
+    void SaveIndex( const TArray< uint8 > & data, bool bSnapshot );
+    // Reads the records written after end, returns false if the last segment ends with an incomplete record
+    bool Replay( int64 end );
+    int32 AddKey( const FString & playerId, const FString & challengeId, bool bWriteRecord );
+    void MarkIndexDirty( int32 keyIndex );
+
+    void StartSegment( int32 segmentIndex );
+    int64 AppendRecord( const FSWAttemptLogRecordHeader & header, const void * payload );
+    void AppendBytes( const void * data, int64 size );
+    // Record at location if it is not written yet, with the bytes that follow it in its chunk
+    const uint8 * FindPending( int64 location, int64 & size ) const;
+
+    void FreeOpenBlock( FKeyEntry & entry );
+    // Frees the open blocks of the keys without attempt for the longest time, beyond OpenBlocksMaxBytes
+    void TrimOpenBlocks();
+
+    // Writes the appended records (and saves the index if bSaveIndex), called by the background thread and by Flush
+    void WritePending( bool bSaveIndex );
+
+    static int64 MakeLocation( int32 segmentIndex, int64 offset )
+    {
+        return ( static_cast< int64 >( segmentIndex ) << 32 ) | offset;
+    }
+
+    mutable FCriticalSection Lock; //Tout sauf ce qui suit WriteLock
+
+    FString Directory;
+    int64 SegmentMaxBytes;
+    int32 WriteBufferBytes;
+
+    TArray< FKeyEntry > Keys; //Indexes par KeyIndex
+    TMap< FSWCacheKey, int32 > KeyIndices;
+    TArray< int32 > IndexDirtyKeys;
+    int64 OpenBlocksBytes = 0;
+    uint64 NbAppends = 0;
+
+    int32 ActiveSegment = 0;
+    int64 ActiveSize = 0;     //Taille du segment courant, chunks pas encore ecrits compris
+    TArray< TUniquePtr< FChunk > > Chunks;
+
+    FCriticalSection WriteLock; //Un seul WritePending a la fois, pour garder l'ordre des chunks
+    int32 WriteSegment = -1;
+    TUniquePtr< IFileHandle > WriteHandle;
+    int32 IndexGeneration = 0; //Les entrees du journal d'une autre generation sont ignorees
+    int64 IndexBytes = 0;
+    int64 JournalBytes = 0;
+    bool bCompactIndex = false;
+
+    FCriticalSection ReadHandlesLock;
+    TArray< TUniquePtr< FReadHandle > > ReadHandles; //MaxReadHandles au plus, le plus ancien rendu en premier
+
+    uint32 FlushMilliseconds;
+    double IndexSaveSeconds;
+    FEvent * WakeEvent = nullptr;
+    FRunnableThread * Thread = nullptr;
+    std::atomic< bool > bStopping { false };
+};
@@ -0,0 +1,64 @@
+#include "SWAttemptStore.h"
+
+#include "SWDDAAttempt.h"
+
+void FSWAttemptStore::Reset()
+{
+    Results.Reset();
+    Thetas.Reset();
+    NumThetas = 0;
+}
+
+void FSWAttemptStore::Reserve( const int nbAttempts )
+{
+    Results.Reserve( nbAttempts );
+    if ( NumThetas > 0 )
+        Thetas.Reserve( nbAttempts * NumThetas );
+}
+
+bool FSWAttemptStore::Add( const float * thetas, const int nbThetas, const float result )
+{
+    //Le premier essai fixe le nombre de variables
+    if ( Results.Num() == 0 )
+        NumThetas = nbThetas;
+    else if ( nbThetas != NumThetas )
+        return false;
+
+    Results.Add( result );
+    Thetas.Append( thetas, nbThetas );
+    return true;
+}
+
+bool FSWAttemptStore::Add( const USWDDAAttempt * attempt )
+{
+    if ( attempt == nullptr )
+        return false;
+
+    return Add( attempt->Thetas.GetData(), attempt->Thetas.Num(), attempt->Result );
+}
+
+void FSWAttemptStore::Assign( const FSWAttemptsView & attempts )
+{
+    Results.Reset( attempts.Num() );
+    Results.Append( attempts.Results.GetData(), attempts.Results.Num() );
+    Thetas.Reset( attempts.Thetas.Num() );
+    Thetas.Append( attempts.Thetas.GetData(), attempts.Thetas.Num() );
+    NumThetas = attempts.NumThetas;
+}
+
+USWDDAAttempt * FSWAttemptStore::MakeAttempt( const FSWAttemptsView & attempts, const int index )
+{
+    auto * attempt = NewObject< USWDDAAttempt >();
+    attempt->Thetas.Append( attempts.GetThetas( index ), attempts.NumThetas );
+    attempt->Result = attempts.GetResult( index );
+    return attempt;
+}
+
+TArray< USWDDAAttempt * > FSWAttemptStore::MakeAttempts( const FSWAttemptsView & attempts )
+{
+    TArray< USWDDAAttempt * > result;
+    result.Reserve( attempts.Num() );
+    for ( auto index = 0; index < attempts.Num(); ++index )
+        result.Add( MakeAttempt( attempts, index ) );
+    return result;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+class USWDDAAttempt;
+
+// Read-only view on attempts stored as plain arrays (struct of arrays) :
+// Results holds one value per attempt, Thetas holds NumThetas values per attempt, attempt after attempt.
+// Attempts are ordered from the oldest to the most recent.
+struct FSWAttemptsView
+{
+    FSWAttemptsView() = default;
+
+    FSWAttemptsView( const TArrayView< const float > results, const TArrayView< const float > thetas, const int numThetas )
+        : Results( results ), Thetas( thetas ), NumThetas( numThetas )
+    {}
+
+    int Num() const
+    {
+        return Results.Num();
+    }
+
+    bool IsEmpty() const
+    {
+        return Results.Num() == 0;
+    }
+
+    float GetResult( const int index ) const
+    {
+        return Results[ index ];
+    }
+
+    const float * GetThetas( const int index ) const
+    {
+        return Thetas.GetData() + index * NumThetas;
+    }
+
+    // the nbLast most recent attempts (all of them if there are fewer)
+    FSWAttemptsView Last( const int nbLast ) const
+    {
+        const auto nb = FMath::Clamp( nbLast, 0, Num() );
+        const auto first = Num() - nb;
+        return FSWAttemptsView( Results.Slice( first, nb ), Thetas.Slice( first * NumThetas, nb * NumThetas ), NumThetas );
+    }
+
+    TArrayView< const float > Results;
+    TArrayView< const float > Thetas;
+    int NumThetas = 0;
+};
+
+// One window of attempts asked to a data manager (see USWDDADataManager::copyAttemptsBatch)
+struct FSWAttemptsRequest
+{
+    FString PlayerId;
+    FString ChallengeId;
+    int NbLastAttempts = 0;
+};
+
+// Attempts stored as plain arrays, without one UObject per attempt (same layout as FSWAttemptsView).
+// NumThetas is set by the first attempt added.
+struct SWARMS_API FSWAttemptStore
+{
+    int Num() const
+    {
+        return Results.Num();
+    }
+
+    bool IsEmpty() const
+    {
+        return Results.Num() == 0;
+    }
+
+    // Empties the store, keeps the allocations
+    void Reset();
+
+    void Reserve( int nbAttempts );
+
+    // Attempts must all have the same number of thetas : returns false (and adds nothing) otherwise
+    bool Add( const float * thetas, int nbThetas, float result );
+    bool Add( const USWDDAAttempt * attempt );
+
+    // Replaces the content with a copy of attempts
+    void Assign( const FSWAttemptsView & attempts );
+
+    float GetResult( const int index ) const
+    {
+        return Results[ index ];
+    }
+
+    const float * GetThetas( const int index ) const
+    {
+        return Thetas.GetData() + index * NumThetas;
+    }
+
+    FSWAttemptsView View() const
+    {
+        return FSWAttemptsView( Results, Thetas, NumThetas );
+    }
+
+    operator FSWAttemptsView() const
+    {
+        return View();
+    }
+
+    // UObject copy of an attempt, for Blueprints (game thread only)
+    static USWDDAAttempt * MakeAttempt( const FSWAttemptsView & attempts, int index );
+    static TArray< USWDDAAttempt * > MakeAttempts( const FSWAttemptsView & attempts );
+
+    TArray< float > Results;
+    TArray< float > Thetas;
+    int NumThetas = 0;
+};
@@ -0,0 +1,329 @@
+#include "SWAttemptWriter.h"
+
+#include "SWAttemptCsv.h"
+
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/Event.h>
+#include <HAL/PlatformFileManager.h>
+#include <HAL/PlatformProcess.h>
+#include <HAL/RunnableThread.h>
+#include <Misc/ScopeLock.h>
+
+FSWAttemptWriter::FSWAttemptWriter( const ESWAttemptFileFormat format, const int32 flushCount, const float flushSeconds )
+    : Format( format )
+{
+    SetFlushPolicy( flushCount, flushSeconds );
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool( false );
+    Thread = FRunnableThread::Create( this, TEXT( "SWAttemptWriter" ), 0, TPri_BelowNormal );
+}
+
+FSWAttemptWriter::~FSWAttemptWriter()
+{
+    if ( Thread != nullptr )
+    {
+        Thread->Kill( true );
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    //Ce qui a ete mis en file apres l'arret du thread
+    WritePending();
+
+    FPlatformProcess::ReturnSynchEventToPool( WakeEvent );
+    WakeEvent = nullptr;
+}
+
+void FSWAttemptWriter::SetFlushPolicy( const int32 flushCount, const float flushSeconds )
+{
+    FlushCount = FMath::Max( flushCount, 1 );
+    FlushMilliseconds = static_cast< uint32 >( FMath::Max( flushSeconds, 0.001f ) * 1000 );
+}
+
+bool FSWAttemptWriter::Enqueue( const FString & fileName, const float * thetas, const int32 nbThetas, const float result )
+{
+    //Un fichier binaire a un nombre de thetas fixe par son en-tete : l'essai est refuse tout de suite plutot que perdu a l'ecriture
+    if ( Format != ESWAttemptFileFormat::CSV )
+    {
+        auto * fileNbThetas = FileNbThetas.Find( fileName );
+        if ( fileNbThetas == nullptr )
+        {
+            //Un en-tete sans theta (ou pas de fichier) : GetOpenFile recree le fichier avec cet essai
+            FSWAttemptFileHeader header;
+            const auto bHeader = FPlatformFileManager::Get().GetPlatformFile().FileSize( *fileName ) > 0
+                && FSWAttemptBinary::ReadHeader( fileName, header ) && header.NbThetas > 0;
+            fileNbThetas = &FileNbThetas.Add( fileName, bHeader ? header.NbThetas : nbThetas );
+        }
+
+        if ( *fileNbThetas != nbThetas )
+            return false;
+    }
+
+    auto bWake = false;
+    {
+        FScopeLock lock( &QueueLock );
+
+        auto * fileIndex = PendingFileIndices.Find( fileName );
+        if ( fileIndex == nullptr )
+        {
+            fileIndex = &PendingFileIndices.Add( fileName, PendingFileNames.Num() );
+            PendingFileNames.Add( fileName );
+        }
+
+        const auto ticks = Format == ESWAttemptFileFormat::BINARY_WITH_TIMESTAMPS ? FDateTime::UtcNow().GetTicks() : 0;
+        Pending.Add( { *fileIndex, PendingThetas.Num(), nbThetas, result, ticks, 0 } );
+        PendingThetas.Append( thetas, nbThetas );
+        bWake = Pending.Num() >= FlushCount;
+    }
+
+    if ( bWake )
+        WakeEvent->Trigger();
+    return true;
+}
+
+void FSWAttemptWriter::Flush()
+{
+    WritePending();
+}
+
+void FSWAttemptWriter::Close( const FString & fileName )
+{
+    FScopeLock writeLock( &WriteLock );
+    WritePending();
+    OpenFiles.Remove( fileName );
+
+    //Le fichier peut etre remplace par un autre nombre de thetas
+    FileNbThetas.Remove( fileName );
+}
+
+bool FSWAttemptWriter::HasPending() const
+{
+    FScopeLock lock( &QueueLock );
+    return Pending.Num() > 0;
+}
+
+bool FSWAttemptWriter::TakeWriteErrors( FString & errors )
+{
+    FScopeLock lock( &QueueLock );
+    errors = MoveTemp( WriteErrors );
+    WriteErrors.Reset();
+    return !errors.IsEmpty();
+}
+
+void FSWAttemptWriter::AddWriteError( const FString & error )
+{
+    FScopeLock lock( &QueueLock );
+    if ( !WriteErrors.IsEmpty() )
+        WriteErrors += TEXT( "\n" );
+    WriteErrors += error;
+}
+
+uint32 FSWAttemptWriter::Run()
+{
+    while ( !bStopping )
+    {
+        //Reveille par Enqueue quand FlushCount essais attendent, sinon toutes les FlushMilliseconds
+        WakeEvent->Wait( FlushMilliseconds );
+        WritePending();
+    }
+
+    return 0;
+}
+
+void FSWAttemptWriter::Stop()
+{
+    bStopping = true;
+    WakeEvent->Trigger();
+}
+
+FSWAttemptWriter::FOpenFile * FSWAttemptWriter::GetOpenFile( const FString & fileName, const int32 nbThetas )
+{
+    if ( auto * openFile = OpenFiles.Find( fileName ) )
+        return openFile;
+
+    //Un serveur ecrit pour beaucoup de joueurs : on ferme le fichier ecrit il y a le plus longtemps
+    if ( OpenFiles.Num() >= MaxOpenFiles )
+    {
+        const FString * oldest = nullptr;
+        auto oldestWrite = MAX_uint64;
+        for ( const auto & entry : OpenFiles )
+        {
+            if ( entry.Value.LastWrite < oldestWrite )
+            {
+                oldest = &entry.Key;
+                oldestWrite = entry.Value.LastWrite;
+            }
+        }
+
+        const auto oldestName = *oldest;
+        OpenFiles.Remove( oldestName );
+    }
+
+    FOpenFile openFile;
+    auto & platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const auto bBinary = Format != ESWAttemptFileFormat::CSV;
+    auto bNewFile = false;
+    if ( bBinary )
+    {
+        //Un fichier existant garde son format, un nouveau fichier prend celui du writer
+        bNewFile = platformFile.FileSize( *fileName ) <= 0;
+        if ( !bNewFile )
+        {
+            if ( !FSWAttemptBinary::ReadHeader( fileName, openFile.Header ) )
+                return nullptr;
+
+            //Un en-tete sans theta ne garderait aucun essai : le fichier est recree avec celui-ci
+            bNewFile = openFile.Header.NbThetas <= 0;
+        }
+
+        if ( bNewFile )
+            openFile.Header = FSWAttemptFileHeader::Make( nbThetas, Format == ESWAttemptFileFormat::BINARY_WITH_TIMESTAMPS );
+    }
+
+    openFile.Handle.Reset( platformFile.OpenWrite( *fileName, !bNewFile, true ) );
+    if ( !openFile.Handle )
+        return nullptr;
+
+    if ( bNewFile && !openFile.Handle->Write( reinterpret_cast< const uint8 * >( &openFile.Header ), sizeof( openFile.Header ) ) )
+        return nullptr;
+
+    return &OpenFiles.Add( fileName, MoveTemp( openFile ) );
+}
+
+void FSWAttemptWriter::WritePending()
+{
+    FScopeLock writeLock( &WriteLock );
+
+    //On prend la file d'un coup : le game thread peut continuer a ajouter pendant l'ecriture
+    {
+        FScopeLock lock( &QueueLock );
+        if ( Pending.Num() == 0 && Writing.Num() == 0 )
+            return;
+
+        if ( Writing.Num() == 0 )
+        {
+            Swap( Pending, Writing );
+            Swap( PendingThetas, WritingThetas );
+            Swap( PendingFileNames, WritingFileNames );
+        }
+        else
+        {
+            //Les essais d'une ecriture ratee restent devant : l'ordre de chaque fichier est garde
+            for ( auto attempt : Pending )
+            {
+                attempt.FileIndex = WritingFileNames.AddUnique( PendingFileNames[ attempt.FileIndex ] );
+                attempt.FirstTheta += WritingThetas.Num();
+                Writing.Add( attempt );
+            }
+            WritingThetas.Append( PendingThetas );
+
+            Pending.Reset();
+            PendingThetas.Reset();
+            PendingFileNames.Reset();
+        }
+        PendingFileIndices.Reset();
+    }
+
+    //Consecutive attempts for the same file are written at once.
+    //Apres un echec, les essais suivants du meme fichier attendent aussi la prochaine ecriture
+    TArray< int32 > failedFiles;
+    auto first = 0;
+    for ( auto index = 1; index <= Writing.Num(); ++index )
+    {
+        if ( index == Writing.Num() || Writing[ index ].FileIndex != Writing[ first ].FileIndex )
+        {
+            const auto fileIndex = Writing[ first ].FileIndex;
+            if ( failedFiles.Contains( fileIndex ) || !WriteAttempts( first, index ) )
+                failedFiles.AddUnique( fileIndex );
+            first = index;
+        }
+    }
+
+    if ( failedFiles.Num() == 0 )
+    {
+        Writing.Reset();
+        WritingThetas.Reset();
+        WritingFileNames.Reset();
+        return;
+    }
+
+    //Les essais non ecrits sont gardes pour la prochaine ecriture, sauf ceux qui ont deja trop echoue
+    TArray< FPendingAttempt > failed;
+    TArray< float > failedThetas;
+    TArray< int32 > nbDropped;
+    nbDropped.AddZeroed( WritingFileNames.Num() );
+    TArray< bool > bFirstFailure;
+    bFirstFailure.AddZeroed( WritingFileNames.Num() );
+    for ( auto attempt : Writing )
+    {
+        if ( !failedFiles.Contains( attempt.FileIndex ) )
+            continue;
+
+        if ( ++attempt.NbFailures >= MaxWriteFailures )
+        {
+            nbDropped[ attempt.FileIndex ]++;
+            continue;
+        }
+
+        bFirstFailure[ attempt.FileIndex ] |= attempt.NbFailures == 1;
+        failedThetas.Append( WritingThetas.GetData() + attempt.FirstTheta, attempt.NbThetas );
+        attempt.FirstTheta = failedThetas.Num() - attempt.NbThetas;
+        failed.Add( attempt );
+    }
+
+    for ( const auto fileIndex : failedFiles )
+    {
+        if ( nbDropped[ fileIndex ] > 0 )
+            AddWriteError( FString::Printf( TEXT( "Could not write %d attempts to %s : they are lost" ), nbDropped[ fileIndex ], *WritingFileNames[ fileIndex ] ) );
+        else if ( bFirstFailure[ fileIndex ] ) //Une seule fois tant que le fichier reste inaccessible
+            AddWriteError( FString::Printf( TEXT( "Could not write attempts to %s : will try again" ), *WritingFileNames[ fileIndex ] ) );
+    }
+
+    Writing = MoveTemp( failed );
+    WritingThetas = MoveTemp( failedThetas );
+}
+
+bool FSWAttemptWriter::WriteAttempts( const int32 first, const int32 last )
+{
+    const auto & fileName = WritingFileNames[ Writing[ first ].FileIndex ];
+    auto * openFile = GetOpenFile( fileName, Writing[ first ].NbThetas );
+    if ( openFile == nullptr )
+        return false;
+    openFile->LastWrite = ++NbWrites;
+
+    Buffer.Reset();
+    if ( Format == ESWAttemptFileFormat::CSV )
+    {
+        FString content;
+        for ( auto index = first; index < last; ++index )
+        {
+            const auto & attempt = Writing[ index ];
+            FSWAttemptCsv::AppendLine( content, WritingThetas.GetData() + attempt.FirstTheta, attempt.NbThetas, attempt.Result );
+        }
+
+        const FTCHARToUTF8 converted( *content );
+        Buffer.Append( reinterpret_cast< const uint8 * >( converted.Get() ), converted.Length() );
+    }
+    else
+    {
+        const auto & header = openFile->Header;
+        for ( auto index = first; index < last; ++index )
+        {
+            //Enqueue a refuse les autres nombres de thetas, sauf si le fichier a ete remplace depuis
+            const auto & attempt = Writing[ index ];
+            if ( attempt.NbThetas == header.NbThetas )
+                FSWAttemptBinary::AppendRecord( Buffer, header, WritingThetas.GetData() + attempt.FirstTheta, attempt.Result, attempt.Ticks );
+        }
+    }
+
+    //Une ecriture partielle est retiree du fichier : les essais seront ecrits en entier au prochain essai
+    auto & handle = *openFile->Handle;
+    const auto position = handle.Tell();
+    if ( !handle.Write( Buffer.GetData(), Buffer.Num() ) || !handle.Flush() )
+    {
+        handle.Truncate( position );
+        OpenFiles.Remove( fileName );
+        return false;
+    }
+
+    return true;
+}
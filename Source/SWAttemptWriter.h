@@ -0,0 +1,113 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <HAL/Runnable.h>
+
+#include "SWAttemptBinary.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+class IFileHandle;
+
+enum class ESWAttemptFileFormat : uint8
+{
+    CSV,                    //see FSWAttemptCsv
+    BINARY,                 //see FSWAttemptFileHeader
+    BINARY_WITH_TIMESTAMPS
+};
+
+// Write-behind queue for the attempt files.
+// The game thread only copies the attempt in memory (Enqueue), a background thread appends the queued attempts
+// to their file by batch, through a file handle kept open. Attempts are written in the order they were queued.
+// At most MaxOpenFiles handles stay open : the least recently written file is closed first.
+// Attempts whose write fails are kept and written again with the next ones, up to MaxWriteFailures times.
+class FSWAttemptWriter : public FRunnable
+{
+public:
+    static constexpr int32 MaxOpenFiles = 64;
+    static constexpr int32 MaxWriteFailures = 8;
+
+    // The background thread writes as soon as flushCount attempts are queued, or flushSeconds after the last write.
+    // A new binary file (or one whose header has no theta) takes the number of thetas of its first attempt
+    FSWAttemptWriter( ESWAttemptFileFormat format, int32 flushCount, float flushSeconds );
+    virtual ~FSWAttemptWriter();
+
+    void SetFlushPolicy( int32 flushCount, float flushSeconds );
+
+    // Game thread : queues the attempt for fileName. Returns false, and queues nothing, if fileName is binary and has
+    // another number of thetas (the header of an existing file is read the first time the file is seen)
+    bool Enqueue( const FString & fileName, const float * thetas, int32 nbThetas, float result );
+
+    // Writes everything queued before returning (shutdown, level change, or before reading a file)
+    void Flush();
+
+    // Flush, then closes fileName so that it can be replaced
+    void Close( const FString & fileName );
+
+    bool HasPending() const;
+
+    // Errors of the background writes since the last call (files that could not be written, attempts dropped).
+    // Returns false if there was none
+    bool TakeWriteErrors( FString & errors );
+
+    // FRunnable
+    uint32 Run() override;
+    void Stop() override;
+
+private:
+    // One queued attempt : its thetas are PendingThetas[ FirstTheta, FirstTheta + NbThetas [, its file is PendingFileNames[ FileIndex ]
+    struct FPendingAttempt
+    {
+        int32 FileIndex;
+        int32 FirstTheta;
+        int32 NbThetas;
+        float Result;
+        int64 Ticks;
+        int32 NbFailures;
+    };
+
+    struct FOpenFile
+    {
+        TUniquePtr< IFileHandle > Handle;
+        FSWAttemptFileHeader Header; //Fichiers binaires
+        uint64 LastWrite = 0;
+    };
+
+    // Writes the queued attempts, called by the background thread and by Flush
+    void WritePending();
+    // Writes Writing[ first, last [, all for the same file. False if nothing was written
+    bool WriteAttempts( int32 first, int32 last );
+    // Background thread : error to give to TakeWriteErrors
+    void AddWriteError( const FString & error );
+    // Open file of fileName, nullptr if it cannot be written
+    FOpenFile * GetOpenFile( const FString & fileName, int32 nbThetas );
+
+    //Les noms ne sont gardes que pour les essais en file : les tables sont videes a chaque WritePending
+    mutable FCriticalSection QueueLock; //Pending, PendingThetas, PendingFileNames, PendingFileIndices
+    TArray< FPendingAttempt > Pending;
+    TArray< float > PendingThetas;
+    TArray< FString > PendingFileNames;
+    TMap< FString, int32 > PendingFileIndices;
+    FString WriteErrors;
+
+    TMap< FString, int32 > FileNbThetas; //Game thread : nombre de thetas de chaque fichier binaire deja vu par Enqueue
+
+    FCriticalSection WriteLock; //Un seul WritePending a la fois, pour garder l'ordre des essais
+    TArray< FPendingAttempt > Writing; //Entre deux WritePending, les essais dont l'ecriture a rate
+    TArray< float > WritingThetas;
+    TArray< FString > WritingFileNames;
+    TMap< FString, FOpenFile > OpenFiles; //MaxOpenFiles au plus
+    uint64 NbWrites = 0;
+    TArray< uint8 > Buffer;
+
+    ESWAttemptFileFormat Format;
+
+    int32 FlushCount;
+    uint32 FlushMilliseconds;
+    FEvent * WakeEvent = nullptr;
+    FRunnableThread * Thread = nullptr;
+    std::atomic< bool > bStopping { false };
+};
@@ -1,16 +1,252 @@
 #include "SWCacheData.h"
 
+#include "SWDDAAttempt.h"
+
 void USWCacheData::Init( const FString playerId, const FString challengeId, const int sizeLimit )
 {
     PlayerId = playerId;
     ChallengeId = challengeId;
+    Key = FSWCacheKey( playerId, challengeId );
     SizeLimit = sizeLimit;
+    Results.Init( sizeLimit );
+    Thetas.Init( 0 ); //Dimensionne au premier essai, quand on connait le nombre de thetas
+    NumThetas = 0;
+    bHoldsWholeFile = false;
+}
+
+void USWCacheData::setSizeLimit( const int sizeLimit )
+{
+    FSWAttemptStore kept;
+    kept.Assign( GetView( sizeLimit ) );
+    const auto bWholeFile = bHoldsWholeFile && kept.Num() == Num();
+
+    Init( PlayerId, ChallengeId, sizeLimit );
+    for ( auto index = 0; index < kept.Num(); ++index )
+        addAttempt( kept.GetThetas( index ), kept.NumThetas, kept.GetResult( index ) );
+    bHoldsWholeFile = bWholeFile;
+}
+
+void USWCacheData::prependAttempts( const FSWAttemptsView & older, const int sizeLimit, const bool bFileStart )
+{
+    FSWAttemptStore kept;
+    kept.Assign( GetView() );
+
+    //Un autre nombre de thetas : les essais plus anciens ne sont pas comparables, le cache a tout ce qui sert
+    const auto bComparable = kept.Num() == 0 || older.NumThetas == kept.NumThetas;
+
+    Init( PlayerId, ChallengeId, sizeLimit );
+    if ( bComparable )
+    {
+        for ( auto index = 0; index < older.Num(); ++index )
+            addAttempt( older.GetThetas( index ), older.NumThetas, older.GetResult( index ) );
+    }
+    for ( auto index = 0; index < kept.Num(); ++index )
+        addAttempt( kept.GetThetas( index ), kept.NumThetas, kept.GetResult( index ) );
+    bHoldsWholeFile = bFileStart || !bComparable;
 }
 
 void USWCacheData::addAttempt( USWDDAAttempt * attempt )
 {
-    Attempts.Add( attempt );
+    addAttempt( attempt->Thetas.GetData(), attempt->Thetas.Num(), attempt->Result );
+}
+
+void USWCacheData::addAttempt( const float * thetas, const int nbThetas, const float result )
+{
+    //Premier essai, ou le nombre de variables a change : les anciens essais ne sont plus comparables
+    if ( Results.IsEmpty() || nbThetas != NumThetas )
+    {
+        NumThetas = nbThetas;
+        Results.Reset();
+        Thetas.Init( SizeLimit * NumThetas );
+    }
+
+    //Une fois plein, le plus ancien essai est remplace : pas de decalage
+    if ( Results.IsFull() )
+        bHoldsWholeFile = false;
+    Results.Add( result );
+    Thetas.Add( thetas, nbThetas );
+}
+
+SIZE_T USWCacheData::GetAllocatedSize() const
+{
+    return sizeof( *this ) + Results.GetAllocatedSize() + Thetas.GetAllocatedSize();
+}
+
+FSWAttemptsView USWCacheData::GetView() const
+{
+    return FSWAttemptsView( Results.GetView(), Thetas.GetView(), NumThetas );
+}
+
+USWCacheData * FSWCacheSet::Load( const FString & playerId, const FString & challengeId, const int nbLastAttempts, FReadFunction read )
+{
+    auto * cache = Find( FSWCacheKey( playerId, challengeId ) );
+
+    if ( cache != nullptr && ( cache->SizeLimit >= nbLastAttempts || cache->bHoldsWholeFile ) )
+    {
+        //On a deja les donnees en cache
+        //En tete du LRU avant de le compter : Evict s'arrete sur lui s'il est en queue
+        Stats.Hits++;
+        Touch( cache );
+        if ( cache->SizeLimit < nbLastAttempts )
+        {
+            //Le fichier n'a pas plus d'essais : on agrandit juste la fenetre
+            cache->setSizeLimit( nbLastAttempts );
+            UpdateBytes( cache );
+        }
+
+        return cache;
+    }
+
+    Stats.Misses++;
+    FSWAttemptStore attempts;
+    if ( cache != nullptr )
+    {
+        //Une fenetre plus grande : on ne lit que les essais qui precedent ceux du cache
+        Touch( cache );
+        const auto nbCached = cache->Num();
+        read( nbCached, nbLastAttempts - nbCached, attempts );
+        cache->prependAttempts( attempts, nbLastAttempts, attempts.Num() < nbLastAttempts - nbCached );
+        UpdateBytes( cache );
+        return cache;
+    }
+
+    //Pas de cache : on lit la fin du fichier, sur nbLastAttempts essais seulement
+    cache = Create( playerId, challengeId, nbLastAttempts );
+    read( 0, nbLastAttempts, attempts );
+    Fill( cache, attempts, nbLastAttempts );
+    return cache;
+}
+
+bool FSWCacheSet::HasWindow( const FString & playerId, const FString & challengeId, const int nbLastAttempts ) const
+{
+    const auto * cache = Find( FSWCacheKey( playerId, challengeId ) );
+    return cache != nullptr && ( cache->SizeLimit >= nbLastAttempts || cache->bHoldsWholeFile );
+}
+
+void FSWCacheSet::OnLoaded( const FString & playerId, const FString & challengeId, const int nbLastAttempts, const FSWAttemptStore & attempts )
+{
+    //getAttempts a pu charger la fenetre entre temps
+    if ( HasWindow( playerId, challengeId, nbLastAttempts ) )
+        return;
+
+    Remove( playerId, challengeId );
+
+    Stats.Prefetches++;
+    Fill( Create( playerId, challengeId, nbLastAttempts ), attempts, nbLastAttempts );
+}
+
+void FSWCacheSet::AddAttempt( const FString & playerId, const FString & challengeId, USWDDAAttempt * attempt )
+{
+    //Sans cache, il sera cree au load, quand on a la taille limite pour le dimensionner
+    auto * cache = Find( FSWCacheKey( playerId, challengeId ) );
+    if ( cache != nullptr )
+    {
+        cache->addAttempt( attempt );
+        Touch( cache );
+        UpdateBytes( cache );
+    }
+}
+
+void FSWCacheSet::Remove( const FString & playerId, const FString & challengeId )
+{
+    if ( auto * cache = Find( FSWCacheKey( playerId, challengeId ) ) )
+        Delete( cache );
+}
+
+void FSWCacheSet::SetBudget( const int64 budgetBytes )
+{
+    BudgetBytes = budgetBytes;
+    Evict( nullptr );
+}
+
+void FSWCacheSet::Fill( USWCacheData * cache, const FSWAttemptStore & attempts, const int nbLastAttempts )
+{
+    for ( auto index = 0; index < attempts.Num(); ++index )
+        cache->addAttempt( attempts.GetThetas( index ), attempts.NumThetas, attempts.GetResult( index ) );
+    cache->bHoldsWholeFile = attempts.Num() < nbLastAttempts;
 
-    if ( Attempts.Num() > SizeLimit )
-        Attempts.RemoveAt( 0 );
+    UpdateBytes( cache );
+}
+
+USWCacheData * FSWCacheSet::Find( const FSWCacheKey & key ) const
+{
+    return Caches.FindRef( key );
+}
+
+USWCacheData * FSWCacheSet::Create( const FString & playerId, const FString & challengeId, const int sizeLimit )
+{
+    const FSWCacheKey key( playerId, challengeId );
+    auto * cache = Find( key );
+
+    if ( cache == nullptr )
+    {
+        cache = NewObject< USWCacheData >();
+        cache->Init( playerId, challengeId, sizeLimit );
+        Caches.Add( key, cache );
+        Stats.NbCaches = Caches.Num();
+    }
+
+    Touch( cache );
+    UpdateBytes( cache );
+    return cache;
+}
+
+void FSWCacheSet::Delete( USWCacheData * cache )
+{
+    Unlink( cache );
+    Stats.UsedBytes -= cache->AccountedBytes;
+    cache->AccountedBytes = 0;
+    Caches.Remove( cache->Key );
+    Stats.NbCaches = Caches.Num();
+}
+
+void FSWCacheSet::Touch( USWCacheData * cache )
+{
+    if ( LRUHead == cache )
+        return;
+
+    Unlink( cache );
+    cache->LRUNext = LRUHead;
+    if ( LRUHead != nullptr )
+        LRUHead->LRUPrev = cache;
+    LRUHead = cache;
+    if ( LRUTail == nullptr )
+        LRUTail = cache;
+}
+
+void FSWCacheSet::Unlink( USWCacheData * cache )
+{
+    if ( cache->LRUPrev != nullptr )
+        cache->LRUPrev->LRUNext = cache->LRUNext;
+    else if ( LRUHead == cache )
+        LRUHead = cache->LRUNext;
+
+    if ( cache->LRUNext != nullptr )
+        cache->LRUNext->LRUPrev = cache->LRUPrev;
+    else if ( LRUTail == cache )
+        LRUTail = cache->LRUPrev;
+
+    cache->LRUPrev = nullptr;
+    cache->LRUNext = nullptr;
+}
+
+void FSWCacheSet::UpdateBytes( USWCacheData * cache )
+{
+    const auto bytes = cache->GetAllocatedSize();
+    if ( bytes == cache->AccountedBytes )
+        return;
+
+    Stats.UsedBytes += static_cast< int64 >( bytes ) - static_cast< int64 >( cache->AccountedBytes );
+    cache->AccountedBytes = bytes;
+    Evict( cache );
+}
+
+void FSWCacheSet::Evict( const USWCacheData * keep )
+{
+    //Le cache en cours d'utilisation est garde meme s'il depasse le budget a lui seul
+    while ( Stats.UsedBytes > BudgetBytes && LRUTail != nullptr && LRUTail != keep )
+    {
+        Delete( LRUTail );
+        Stats.Evictions++;
+    }
 }
@@ -2,10 +2,56 @@
 
 #include <CoreMinimal.h>
 
+#include "SWAttemptStore.h"
+#include "SWRingBuffer.h"
+
 #include "SWCacheData.generated.h"
 
 class USWDDAAttempt;
 
+//Compteurs du cache des essais
+struct FSWCacheStats
+{
+    int64 Hits = 0;      //Fenetre trouvee en memoire
+    int64 Misses = 0;    //Fenetre chargee depuis le fichier
+    int64 Evictions = 0; //Caches liberes pour rester dans le budget
+    int64 Prefetches = 0; //Fenetres chargees en tache de fond (getAttemptsAsync, prefetch)
+    int32 NbCaches = 0;
+    int64 UsedBytes = 0;
+};
+
+//Identifiant d'un joueur et d'un challenge, sensible a la casse : "Alice" et "alice" sont deux joueurs
+//(FName et l'operateur == de FString ignorent la casse). Le hash est calcule une fois, a la construction
+USTRUCT()
+struct FSWCacheKey
+{
+    GENERATED_BODY()
+
+    FSWCacheKey() = default;
+
+    FSWCacheKey( const FString & playerId, const FString & challengeId )
+        : PlayerId( playerId ), ChallengeId( challengeId )
+        , Hash( HashCombine( FCrc::StrCrc32( *playerId ), FCrc::StrCrc32( *challengeId ) ) )
+    {}
+
+    bool operator==( const FSWCacheKey & other ) const
+    {
+        return Hash == other.Hash && PlayerId.Equals( other.PlayerId, ESearchCase::CaseSensitive )
+            && ChallengeId.Equals( other.ChallengeId, ESearchCase::CaseSensitive );
+    }
+
+    friend uint32 GetTypeHash( const FSWCacheKey & key )
+    {
+        return key.Hash;
+    }
+
+    UPROPERTY()
+    FString PlayerId;
+    UPROPERTY()
+    FString ChallengeId;
+    uint32 Hash = 0;
+};
+
 UCLASS()
 class USWCacheData : public UObject
 {
@@ -14,10 +60,104 @@ class USWCacheData : public UObject
 public:
     void Init( FString playerId, FString challengeId, int sizeLimit = 1000 );
 
+    //Les donnees de l'essai sont copiees, l'objet n'est pas garde
     void addAttempt( USWDDAAttempt * attempt );
+    void addAttempt( const float * thetas, int nbThetas, float result );
+
+    int Num() const
+    {
+        return Results.Num();
+    }
+
+    //Les SizeLimit derniers essais, du plus ancien au plus recent, sans copie
+    FSWAttemptsView GetView() const;
+
+    //Les nbLast derniers essais (tous s'il y en a moins), sans copie
+    FSWAttemptsView GetView( const int nbLast ) const
+    {
+        return GetView().Last( nbLast );
+    }
+
+    //Change la taille de la fenetre en gardant les essais les plus recents
+    void setSizeLimit( int sizeLimit );
+
+    //Agrandit la fenetre a sizeLimit avec older, les essais du fichier qui precedent ceux du cache (le plus ancien d'abord).
+    //bFileStart : le fichier n'a pas d'essai plus ancien
+    void prependAttempts( const FSWAttemptsView & older, int sizeLimit, bool bFileStart );
+
+    //Memoire occupee par le cache, en octets
+    SIZE_T GetAllocatedSize() const;
 
-    TArray< USWDDAAttempt * > Attempts;
     FString PlayerId;
     FString ChallengeId;
+    FSWCacheKey Key;
     int SizeLimit = 1000;
-};
\ No newline at end of file
+    //Tous les essais du fichier sont dans le cache : une fenetre plus grande n'a rien a relire
+    bool bHoldsWholeFile = false;
+
+    //Liste LRU du data manager (du plus recemment utilise au plus ancien)
+    USWCacheData * LRUPrev = nullptr;
+    USWCacheData * LRUNext = nullptr;
+    SIZE_T AccountedBytes = 0; //Taille comptee dans le budget du data manager
+
+private:
+    //Struct of arrays : Results et Thetas sont contigus, NumThetas thetas par essai
+    TSWRingBuffer< float > Results;
+    TSWRingBuffer< float > Thetas;
+    int NumThetas = 0;
+};
+//Caches of the attempt windows of a data manager, one per player and challenge.
+//Each cache keeps the largest window asked, the smaller ones are its end. Beyond BudgetBytes, the least recently used caches are released
+USTRUCT()
+struct FSWCacheSet
+{
+    GENERATED_BODY()
+
+    //Reads the nbLastAttempts attempts of the storage that precede its nbSkipped last ones, the oldest first
+    using FReadFunction = TFunctionRef< void( int nbSkipped, int nbLastAttempts, FSWAttemptStore & attempts ) >;
+
+    //Cache holding the nbLastAttempts last attempts, read with read if they are not in memory.
+    //A larger window only reads the attempts older than the cached ones
+    USWCacheData * Load( const FString & playerId, const FString & challengeId, int nbLastAttempts, FReadFunction read );
+
+    //True if Load does not need to read this window
+    bool HasWindow( const FString & playerId, const FString & challengeId, int nbLastAttempts ) const;
+
+    //Window read in the background : kept, unless it was loaded in the meantime
+    void OnLoaded( const FString & playerId, const FString & challengeId, int nbLastAttempts, const FSWAttemptStore & attempts );
+
+    //New attempt saved : added to its cache if there is one
+    void AddAttempt( const FString & playerId, const FString & challengeId, USWDDAAttempt * attempt );
+
+    //The storage of this player and challenge was replaced : its cache is released
+    void Remove( const FString & playerId, const FString & challengeId );
+
+    void SetBudget( int64 budgetBytes );
+
+    const FSWCacheStats & GetStats() const
+    {
+        return Stats;
+    }
+
+    int64 BudgetBytes = 64 * 1024 * 1024;
+
+private:
+    void Fill( USWCacheData * cache, const FSWAttemptStore & attempts, int nbLastAttempts );
+
+    USWCacheData * Find( const FSWCacheKey & key ) const;
+    USWCacheData * Create( const FString & playerId, const FString & challengeId, int sizeLimit );
+    void Delete( USWCacheData * cache );
+
+    //LRU : le cache utilise passe en tete, on libere par la queue
+    void Touch( USWCacheData * cache );
+    void Unlink( USWCacheData * cache );
+    //A appeler quand la taille d'un cache a pu changer, libere les plus anciens si le budget est depasse
+    void UpdateBytes( USWCacheData * cache );
+    void Evict( const USWCacheData * keep );
+
+    UPROPERTY()
+    TMap< FSWCacheKey, USWCacheData * > Caches;
+    USWCacheData * LRUHead = nullptr; //Plus recemment utilise
+    USWCacheData * LRUTail = nullptr; //Premier a liberer
+    FSWCacheStats Stats;
+};
@@ -0,0 +1,32 @@
+#include "SWComputeDiffParamsAction.h"
+
+USWComputeDiffParamsAction * USWComputeDiffParamsAction::computeNewDiffParamsAsync( UObject * worldContextObject, USWDDAModel * model, const float targetDifficulty, const bool doNotUpdateLRAccuracy )
+{
+    auto * action = NewObject<USWComputeDiffParamsAction>();
+    action->Model = model;
+    action->TargetDifficulty = targetDifficulty;
+    action->bDoNotUpdateLRAccuracy = doNotUpdateLRAccuracy;
+
+    //Garde l'action en vie jusqu'a SetReadyToDestroy
+    action->RegisterWithGameInstance( worldContextObject );
+    return action;
+}
+
+void USWComputeDiffParamsAction::Activate()
+{
+    if ( Model == nullptr )
+    {
+        SetReadyToDestroy();
+        return;
+    }
+
+    TWeakObjectPtr<USWComputeDiffParamsAction> weakThis( this );
+    Model->computeNewDiffParamsAsync( TargetDifficulty, bDoNotUpdateLRAccuracy, [weakThis]( const FSWDiffParams & diffParams )
+    {
+        if ( auto * action = weakThis.Get() )
+        {
+            action->Completed.Broadcast( diffParams );
+            action->SetReadyToDestroy();
+        }
+    } );
+}
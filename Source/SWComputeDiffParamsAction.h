@@ -0,0 +1,34 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <Kismet/BlueprintAsyncActionBase.h>
+
+#include "SWDDAModel.h"
+
+#include "SWComputeDiffParamsAction.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( FSWOnDiffParamsComputed, const FSWDiffParams &, DiffParams );
+
+//Blueprint node for USWDDAModel::computeNewDiffParamsAsync : the regression is computed on a worker thread,
+//Completed is triggered on the game thread with the new difficulty parameters
+UCLASS()
+class SWARMS_API USWComputeDiffParamsAction : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION( BlueprintCallable, meta = ( BlueprintInternalUseOnly = "true", WorldContext = "worldContextObject" ) )
+    static USWComputeDiffParamsAction * computeNewDiffParamsAsync( UObject * worldContextObject, USWDDAModel * model, float targetDifficulty, bool doNotUpdateLRAccuracy = false );
+
+    void Activate() override;
+
+    UPROPERTY( BlueprintAssignable )
+    FSWOnDiffParamsComputed Completed;
+
+private:
+    UPROPERTY()
+    USWDDAModel * Model = nullptr;
+    float TargetDifficulty = 0;
+    bool bDoNotUpdateLRAccuracy = false;
+};
@@ -5,21 +5,28 @@ bool USWDDAAttempt::IsSame( USWDDAAttempt * other )
     if ( other == nullptr )
         return false;
 
-    if ( !( other->Thetas.Num() == 0 && Thetas.Num() == 0 ) )
+    return IsSame( other->Thetas.GetData(), other->Thetas.Num(), other->Result );
+}
+
+bool USWDDAAttempt::IsSame( const float * thetas, const int nbThetas, const float result ) const
+{
+    if ( !( nbThetas == 0 && Thetas.Num() == 0 ) )
     {
-        if ( other->Thetas.Num() == 0 )
+        if ( nbThetas == 0 )
             return false;
         if ( Thetas.Num() == 0 )
             return false;
+        if ( Thetas.Num() > nbThetas )
+            return false;
 
         float delta = 0;
         for ( auto index = 0; index < Thetas.Num(); ++index )
-            delta += FMath::Abs( Thetas[ index ] - other->Thetas[ index ] );
+            delta += FMath::Abs( Thetas[ index ] - thetas[ index ] );
         if ( delta / Thetas.Num() > 0.00001 )
             return false;
     }
 
-    if ( Result != other->Result )
+    if ( Result != result )
         return false;
 
     return true;
@@ -16,4 +16,5 @@ public:
     float Result;           //1 if player won this challenge, 0 if not
 
     bool IsSame( USWDDAAttempt * other ); //Not using equals because dont want to mess with Equals and hashcodes, object not immutable (should be ?)
+    bool IsSame( const float * thetas, int nbThetas, float result ) const; //Same test against raw data (see FSWAttemptStore)
 };
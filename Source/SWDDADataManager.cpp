@@ -1 +1,31 @@
 #include "SWDDADataManager.h"
+
+#include <Async/Async.h>
+
+TFuture< FSWAttemptStore > USWDDADataManager::getAttemptsAsync( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    TPromise< FSWAttemptStore > promise;
+    FSWAttemptStore attempts;
+    copyAttempts( playerId, challengeId, nbLastAttempts, attempts );
+    promise.SetValue( MoveTemp( attempts ) );
+    return promise.GetFuture();
+}
+
+void USWDDADataManager::copyAttemptsBatch( const TArray< FSWAttemptsRequest > & requests, TArray< FSWAttemptStore > & attempts )
+{
+    attempts.SetNum( requests.Num() );
+    for ( auto index = 0; index < requests.Num(); ++index )
+        copyAttempts( requests[ index ].PlayerId, requests[ index ].ChallengeId, requests[ index ].NbLastAttempts, attempts[ index ] );
+}
+
+void USWDDADataManager::loadAttemptsAsync( const FString playerId, const FString challengeId, const int nbLastAttempts, FSWOnAttemptsLoaded onLoaded )
+{
+    getAttemptsAsync( playerId, challengeId, nbLastAttempts ).Next( [onLoaded]( FSWAttemptStore attempts )
+    {
+        //Les UObjects sont crees sur le game thread
+        AsyncTask( ENamedThreads::GameThread, [onLoaded, attempts]()
+        {
+            onLoaded.ExecuteIfBound( FSWAttemptStore::MakeAttempts( attempts ) );
+        } );
+    } );
+}
@@ -2,10 +2,17 @@
 
 #include <CoreMinimal.h>
 
+#include <Async/Future.h>
+
+#include "SWAttemptStore.h"
+
 #include "SWDDaDataManager.generated.h"
 
 class USWDDAAttempt;
 
+//Called on the game thread with the loaded attempts
+DECLARE_DYNAMIC_DELEGATE_OneParam( FSWOnAttemptsLoaded, const TArray< USWDDAAttempt * > &, Attempts );
+
 UCLASS( Abstract )
 class SWARMS_API USWDDADataManager : public UObject
 {
@@ -21,4 +28,46 @@ public:
     {
         return TArray< USWDDAAttempt * >();
     }
+
+    //Same as getAttempts, as plain data (no UObject), without copy when the data manager has the attempts in memory
+    //The view is only valid until the next call to the data manager
+    virtual FSWAttemptsView getAttemptsView( FString playerId, FString challengeId, int nbLastAttempts )
+    {
+        AttemptsViewStorage.Reset();
+        for ( const auto * attempt : getAttempts( playerId, challengeId, nbLastAttempts ) )
+            AttemptsViewStorage.Add( attempt );
+        return AttemptsViewStorage;
+    }
+
+    //Same as copyAttempts, without blocking the game thread when the data manager can read its storage in the background.
+    //Once the future is set, getAttempts for the same window no longer waits for the storage.
+    //The default version reads synchronously and returns a future already set
+    virtual TFuture< FSWAttemptStore > getAttemptsAsync( FString playerId, FString challengeId, int nbLastAttempts );
+
+    //Blueprint version of getAttemptsAsync
+    UFUNCTION( BlueprintCallable )
+    void loadAttemptsAsync( FString playerId, FString challengeId, int nbLastAttempts, FSWOnAttemptsLoaded onLoaded );
+
+    //Loads in the background the nbLastAttempts last attempts of this player for each of these challenges (at login for instance),
+    //so that the first difficulty query of a challenge does not wait for the storage
+    virtual void prefetch( FString playerId, const TArray< FString > & challengeIds, int nbLastAttempts )
+    {}
+
+    //Writes the attempts that are still pending to the storage before returning (shutdown, level change)
+    virtual void flush()
+    {}
+
+    //Copy of nbLastAttempts of this player for this challenge in a store owned by the caller (can be read from another thread)
+    void copyAttempts( const FString playerId, const FString challengeId, const int nbLastAttempts, FSWAttemptStore & attempts )
+    {
+        attempts.Assign( getAttemptsView( playerId, challengeId, nbLastAttempts ) );
+    }
+
+    //copyAttempts for many players and challenges at once (see USWDDAModel::computeNewDiffParamsBatch) : attempts[ i ] is the window of requests[ i ].
+    //The default version calls copyAttempts for each request, data managers override it to read their storage in one go
+    virtual void copyAttemptsBatch( const TArray< FSWAttemptsRequest > & requests, TArray< FSWAttemptStore > & attempts );
+
+protected:
+    //Attempts returned by the default getAttemptsView
+    FSWAttemptStore AttemptsViewStorage;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "SWDDADataManager_LocalBinary.h"
+
+#include "SWAttemptBinary.h"
+#include "SWAttemptCsv.h"
+
+USWDDADataManager_LocalBinary::USWDDADataManager_LocalBinary()
+{
+    FileDataName = "data.swa";
+    CsvFileDataName = "data.csv";
+    FileFormat = ESWAttemptFileFormat::BINARY;
+}
+
+void USWDDADataManager_LocalBinary::setWriteTimestamps( const bool bTimestamps )
+{
+    FileFormat = bTimestamps ? ESWAttemptFileFormat::BINARY_WITH_TIMESTAMPS : ESWAttemptFileFormat::BINARY;
+}
+
+bool USWDDADataManager_LocalBinary::importCsv( const FString & playerId, const FString & challengeId )
+{
+    FSWAttemptStore attempts;
+    auto bSameNbThetas = true;
+    FSWAttemptCsv::ReadLast(getCsvFileName(playerId, challengeId), -1, [&attempts, &bSameNbThetas]( const float * thetas, const int32 nbThetas, const float result )
+    {
+        bSameNbThetas &= attempts.Add(thetas, nbThetas, result);
+    });
+
+    if (!bSameNbThetas)
+    {
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not import attempts : their number of thetas changes in the file"));
+        return false;
+    }
+
+    //Un fichier sans essai ne dirait pas combien de thetas attendre
+    if (attempts.Num() == 0)
+    {
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not import attempts : the CSV file is missing or empty"));
+        return false;
+    }
+
+    //Les essais en file d'attente doivent etre dans le fichier : ils ne sont jamais ecrases
+    flush();
+    const auto fileName = getFileName(playerId, challengeId);
+    FSWAttemptStore saved;
+    if (FSWAttemptBinary::ReadLast(fileName, 1, saved) && saved.Num() > 0)
+    {
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not import attempts : the binary file already has attempts"));
+        return false;
+    }
+
+    //Le writer ne doit plus avoir l'ancien fichier ouvert, ni le cache ses essais
+    closeFile(playerId, challengeId);
+    return FSWAttemptBinary::Save(fileName, attempts);
+}
+
+bool USWDDADataManager_LocalBinary::exportCsv( const FString & playerId, const FString & challengeId )
+{
+    flush();
+
+    FSWAttemptStore attempts;
+    if (!FSWAttemptBinary::ReadLast(getFileName(playerId, challengeId), -1, attempts))
+        return false;
+
+    return FSWAttemptCsv::Save(getCsvFileName(playerId, challengeId), attempts);
+}
+
+FString USWDDADataManager_LocalBinary::getCsvFileName( const FString & playerId, const FString & challengeId ) const
+{
+    return FPaths::ProjectDir() + playerId + "_" + challengeId + CsvFileDataName;
+}
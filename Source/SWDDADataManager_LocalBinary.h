@@ -0,0 +1,32 @@
+#pragma once
+
+#include "SWDDADataManager_LocalFile.h"
+
+#include <CoreMinimal.h>
+
+#include "SWDDADataManager_LocalBinary.generated.h"
+
+//Attempts in binary files (see FSWAttemptFileHeader), read through a memory mapping without parsing.
+//Can import the files of USWDDADataManager_LocalCSV, and export back to them
+UCLASS(BlueprintType)
+class USWDDADataManager_LocalBinary : public USWDDADataManager_LocalFile
+{
+    GENERATED_BODY()
+
+public:
+    USWDDADataManager_LocalBinary();
+
+    //Creates the binary file of this player for this challenge from its CSV file (see USWDDADataManager_LocalCSV).
+    //Fails if the CSV file has no attempt, or if the binary file already has some
+    bool importCsv( const FString & playerId, const FString & challengeId );
+    //Replaces the CSV file of this player for this challenge by the content of its binary file. Values are kept exactly
+    bool exportCsv( const FString & playerId, const FString & challengeId );
+
+    //New files also store the time of each attempt. To call before the first attempt is saved
+    void setWriteTimestamps( bool bTimestamps );
+
+private:
+    FString getCsvFileName( const FString & playerId, const FString & challengeId ) const;
+
+    FString CsvFileDataName;
+};
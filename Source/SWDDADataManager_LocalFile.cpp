@@ -0,0 +1,266 @@
+#include "SWDDADataManager_LocalFile.h"
+
+#include "SWAttemptBinary.h"
+#include "SWAttemptCsv.h"
+#include "SWDDAAttempt.h"
+
+#include <Async/Async.h>
+#include <Async/ParallelFor.h>
+#include <Misc/CoreDelegates.h>
+#include <UObject/UObjectGlobals.h>
+
+USWDDADataManager_LocalFile::USWDDADataManager_LocalFile()
+{
+    if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+    {
+        //Les essais en attente sont ecrits avant de quitter ou de changer de niveau
+        PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &USWDDADataManager_LocalFile::onPreLoadMap);
+        PreExitHandle = FCoreDelegates::OnPreExit.AddUObject(this, &USWDDADataManager_LocalFile::flush);
+    }
+}
+
+void USWDDADataManager_LocalFile::BeginDestroy()
+{
+    FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+    FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+
+    Super::BeginDestroy();
+}
+
+bool USWDDADataManager_LocalFile::IsReadyForFinishDestroy()
+{
+    //Les lectures en cours utilisent le writer
+    return *NbLoadsInFlight == 0 && Super::IsReadyForFinishDestroy();
+}
+
+void USWDDADataManager_LocalFile::FinishDestroy()
+{
+    //Arrete le thread apres avoir tout ecrit
+    Writer.Reset();
+
+    Super::FinishDestroy();
+}
+
+void USWDDADataManager_LocalFile::addAttempt( const FString playerId, const FString challengeId, USWDDAAttempt * attempt )
+{
+    //On va stocker les donnees en cache
+    Caches.AddAttempt(playerId, challengeId, attempt);
+    saveAttempt(playerId, challengeId, attempt);
+}
+
+TArray<USWDDAAttempt *> USWDDADataManager_LocalFile::getAttempts( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    //Les UObjects ne sont crees que pour les Blueprints, le cache garde des donnees brutes
+    return FSWAttemptStore::MakeAttempts(getAttemptsView(playerId, challengeId, nbLastAttempts));
+}
+
+FSWAttemptsView USWDDADataManager_LocalFile::getAttemptsView( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    const auto fileName = getFileName(playerId, challengeId);
+    if (nbLastAttempts < 0)
+    {
+        //Tout le fichier : trop grand pour etre garde en cache
+        flush();
+        readAttempts(FileFormat, fileName, nbLastAttempts, AttemptsViewStorage);
+        return AttemptsViewStorage;
+    }
+
+    //Une lecture en tache de fond couvre deja la fenetre (prefetch de Init) : on l'attend plutot que de relire le fichier
+    const auto * loadingWindow = LoadingWindows.Find(fileName);
+    if (loadingWindow != nullptr && loadingWindow->NbLastAttempts >= nbLastAttempts && loadingWindow->NbAttemptsSavedAtStart == NbAttemptsSaved
+        && !Caches.HasWindow(playerId, challengeId, nbLastAttempts))
+    {
+        Caches.OnLoaded(playerId, challengeId, loadingWindow->NbLastAttempts, loadingWindow->Attempts.Get());
+        LoadingWindows.Remove(fileName);
+    }
+
+    auto * cache = Caches.Load(playerId, challengeId, nbLastAttempts, [this, &fileName]( const int nbSkipped, const int nbAttempts, FSWAttemptStore & attempts )
+    {
+        //Le fichier doit contenir les essais encore en file d'attente
+        flush();
+        readAttempts(FileFormat, fileName, nbAttempts, attempts, nbSkipped);
+    });
+
+    //Le cache garde la plus grande fenetre demandee, les plus petites en sont la fin
+    return cache->GetView(nbLastAttempts);
+}
+
+void USWDDADataManager_LocalFile::flush()
+{
+    if (Writer)
+        Writer->Flush();
+}
+
+void USWDDADataManager_LocalFile::setWritePolicy( const int32 flushCount, const float flushSeconds )
+{
+    WriteFlushCount = flushCount;
+    WriteFlushSeconds = flushSeconds;
+    if (Writer)
+        Writer->SetFlushPolicy(flushCount, flushSeconds);
+}
+
+void USWDDADataManager_LocalFile::setCacheBudget( const int64 budgetBytes )
+{
+    Caches.SetBudget(budgetBytes);
+}
+
+FString USWDDADataManager_LocalFile::getFileName( const FString & playerId, const FString & challengeId ) const
+{
+    return FPaths::ProjectDir() + playerId + "_" + challengeId + FileDataName;
+}
+
+FSWAttemptWriter & USWDDADataManager_LocalFile::getWriter()
+{
+    if (!Writer)
+        Writer = MakeUnique<FSWAttemptWriter>(FileFormat, WriteFlushCount, WriteFlushSeconds);
+    return *Writer;
+}
+
+void USWDDADataManager_LocalFile::saveAttempt( const FString & playerId, const FString & challengeId, const USWDDAAttempt * attempt )
+{
+    NbAttemptsSaved++;
+
+    //On sauve en tache de fond : le game thread ne fait que copier l'essai
+    auto & writer = getWriter();
+    if (!writer.Enqueue(getFileName(playerId, challengeId), attempt->Thetas.GetData(), attempt->Thetas.Num(), attempt->Result))
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not save attempt : its number of thetas is not the one of the file"));
+
+    //Les erreurs des ecritures precedentes, faites en tache de fond
+    FString errors;
+    if (writer.TakeWriteErrors(errors))
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, errors);
+}
+
+TFuture<FSWAttemptStore> USWDDADataManager_LocalFile::getAttemptsAsync( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    //Deja en memoire : rien a lire
+    if (Caches.HasWindow(playerId, challengeId, nbLastAttempts))
+        return Super::getAttemptsAsync(playerId, challengeId, nbLastAttempts);
+
+    const auto fileName = getFileName(playerId, challengeId);
+    const auto nbSavedAtStart = NbAttemptsSaved;
+    //Le writer vit jusqu'a FinishDestroy, qui attend la fin des lectures
+    auto * writer = Writer.Get();
+    const auto format = FileFormat;
+    auto nbLoadsInFlight = NbLoadsInFlight;
+    TWeakObjectPtr<USWDDADataManager_LocalFile> weakThis(this);
+
+    //Le resultat est aussi partage avec getAttemptsView, qui peut l'attendre sur le game thread
+    auto loaded = MakeShared<TPromise<FSWAttemptStore>, ESPMode::ThreadSafe>();
+    auto & loadingWindow = LoadingWindows.FindOrAdd(fileName);
+    if (!loadingWindow.Attempts.IsValid() || loadingWindow.NbLastAttempts <= nbLastAttempts)
+        loadingWindow = {nbLastAttempts, nbSavedAtStart, loaded->GetFuture().Share()};
+
+    (*nbLoadsInFlight)++;
+    return Async(EAsyncExecution::ThreadPool, [weakThis, writer, format, nbLoadsInFlight, loaded, fileName, playerId, challengeId, nbLastAttempts, nbSavedAtStart]()
+    {
+        //Le fichier doit contenir les essais encore en file d'attente
+        if (writer != nullptr)
+            writer->Flush();
+
+        FSWAttemptStore attempts;
+        readAttempts(format, fileName, nbLastAttempts, attempts);
+        loaded->SetValue(attempts);
+
+        //Le cache n'est modifie que par le game thread
+        //Si un essai a ete sauve pendant la lecture, elle n'est peut-etre plus a jour : getAttempts relira le fichier
+        AsyncTask(ENamedThreads::GameThread, [weakThis, fileName, playerId, challengeId, nbLastAttempts, nbSavedAtStart, attempts]()
+        {
+            if (!weakThis.IsValid())
+                return;
+
+            const auto * loadingWindow = weakThis->LoadingWindows.Find(fileName);
+            if (loadingWindow != nullptr && loadingWindow->NbLastAttempts == nbLastAttempts && loadingWindow->NbAttemptsSavedAtStart == nbSavedAtStart)
+                weakThis->LoadingWindows.Remove(fileName);
+
+            if (weakThis->NbAttemptsSaved == nbSavedAtStart)
+                weakThis->Caches.OnLoaded(playerId, challengeId, nbLastAttempts, attempts);
+        });
+
+        (*nbLoadsInFlight)--;
+        return attempts;
+    });
+}
+
+void USWDDADataManager_LocalFile::prefetch( const FString playerId, const TArray<FString> & challengeIds, const int nbLastAttempts )
+{
+    for (const auto & challengeId : challengeIds)
+    {
+        //Deja en memoire, ou une lecture en cours la couvre
+        const auto * loadingWindow = LoadingWindows.Find(getFileName(playerId, challengeId));
+        if (!Caches.HasWindow(playerId, challengeId, nbLastAttempts) && (loadingWindow == nullptr || loadingWindow->NbLastAttempts < nbLastAttempts))
+            getAttemptsAsync(playerId, challengeId, nbLastAttempts);
+    }
+}
+
+void USWDDADataManager_LocalFile::copyAttemptsBatch( const TArray<FSWAttemptsRequest> & requests, TArray<FSWAttemptStore> & attempts )
+{
+    attempts.SetNum(requests.Num());
+
+    //Les fichiers doivent contenir les essais encore en file d'attente
+    flush();
+
+    TArray<int32> toRead;
+    TArray<FString> fileNames;
+    for (auto index = 0; index < requests.Num(); ++index)
+    {
+        const auto & request = requests[index];
+        if (Caches.HasWindow(request.PlayerId, request.ChallengeId, request.NbLastAttempts))
+        {
+            copyAttempts(request.PlayerId, request.ChallengeId, request.NbLastAttempts, attempts[index]);
+        }
+        else
+        {
+            toRead.Add(index);
+            fileNames.Add(getFileName(request.PlayerId, request.ChallengeId));
+        }
+    }
+
+    //Un fichier par tache
+    const auto format = FileFormat;
+    ParallelFor(toRead.Num(), [format, &requests, &attempts, &toRead, &fileNames]( const int32 task )
+    {
+        readAttempts(format, fileNames[task], requests[toRead[task]].NbLastAttempts, attempts[toRead[task]]);
+    });
+
+    //Game thread : ce qui a ete lu peut etre garde en memoire
+    for (const auto index : toRead)
+        Caches.OnLoaded(requests[index].PlayerId, requests[index].ChallengeId, requests[index].NbLastAttempts, attempts[index]);
+}
+
+void USWDDADataManager_LocalFile::readAttempts( const ESWAttemptFileFormat format, const FString & fileName, const int nbLastAttempts, FSWAttemptStore & attempts, const int nbSkipped )
+{
+    if (format != ESWAttemptFileFormat::CSV)
+    {
+        //Mapping du fichier, sans parsing
+        FSWAttemptBinary::ReadLast(fileName, nbLastAttempts, attempts, nbSkipped);
+        return;
+    }
+
+    attempts.Reset();
+    attempts.Reserve(FMath::Max(nbLastAttempts, 0));
+    FSWAttemptCsv::ReadLast(fileName, nbLastAttempts, [&attempts]( const float * thetas, const int32 nbThetas, const float result )
+    {
+        //Comme dans le cache : si le nombre de thetas change, seuls les essais suivants sont gardes
+        if (!attempts.Add(thetas, nbThetas, result))
+        {
+            attempts.Reset();
+            attempts.Add(thetas, nbThetas, result);
+        }
+    }, nbSkipped);
+}
+
+void USWDDADataManager_LocalFile::closeFile( const FString & playerId, const FString & challengeId )
+{
+    const auto fileName = getFileName(playerId, challengeId);
+    if (Writer)
+        Writer->Close(fileName);
+    Caches.Remove(playerId, challengeId);
+    //Le fichier peut etre remplace : une lecture en cours ne doit plus etre reprise par getAttemptsView
+    LoadingWindows.Remove(fileName);
+}
+
+void USWDDADataManager_LocalFile::onPreLoadMap( const FString & mapName )
+{
+    flush();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "SWAttemptWriter.h"
+#include "SWCacheData.h"
+#include "SWDDADataManager.h"
+
+#include <CoreMinimal.h>
+
+#include <atomic>
+
+#include "SWDDADataManager_LocalFile.generated.h"
+
+//Data managers keeping one file per player and challenge in the project directory, written by a background thread.
+//The last attempts read are kept in memory (see FSWCacheSet) : a window already read never touches the file again
+UCLASS( Abstract )
+class SWARMS_API USWDDADataManager_LocalFile : public USWDDADataManager
+{
+    GENERATED_BODY()
+
+public:
+    USWDDADataManager_LocalFile();
+
+    void BeginDestroy() override;
+    //Waits for the files being read in the background, without blocking the game thread
+    bool IsReadyForFinishDestroy() override;
+    void FinishDestroy() override;
+
+    //Save all these new attempts for this player and this challenge
+    void addAttempt( FString playerId, FString challengeId, USWDDAAttempt * attempt ) override;
+    //Get nbLastAttempts of this player for this challenge
+    TArray< USWDDAAttempt * > getAttempts( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    //Get nbLastAttempts of this player for this challenge, directly in the cache
+    FSWAttemptsView getAttemptsView( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    //Reads the file on a thread of the pool, then keeps the attempts in the cache on the game thread
+    TFuture< FSWAttemptStore > getAttemptsAsync( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    void prefetch( FString playerId, const TArray< FString > & challengeIds, int nbLastAttempts ) override;
+    //The files of the windows that are not in memory are read in parallel
+    void copyAttemptsBatch( const TArray< FSWAttemptsRequest > & requests, TArray< FSWAttemptStore > & attempts ) override;
+
+    //Writes the queued attempts to their file before returning. Done automatically at exit and before loading a map
+    void flush() override;
+
+    //The attempts are written to the files by a background thread, as soon as flushCount attempts are waiting
+    //or flushSeconds after the previous write
+    void setWritePolicy( int32 flushCount, float flushSeconds );
+
+    //Memory allowed for the caches, in bytes. The least recently used caches are released beyond it
+    void setCacheBudget( int64 budgetBytes );
+
+    const FSWCacheStats & getCacheStats() const
+    {
+        return Caches.GetStats();
+    }
+
+    int32 WriteFlushCount = 32;
+    float WriteFlushSeconds = 2.0f;
+
+protected:
+    FString getFileName( const FString & playerId, const FString & challengeId ) const;
+
+    //Cree au premier essai sauve, pour ne pas lancer de thread pour le CDO
+    FSWAttemptWriter & getWriter();
+    //Queues the attempt for the file of this player and challenge
+    void saveAttempt( const FString & playerId, const FString & challengeId, const USWDDAAttempt * attempt );
+    //Writes the queued attempts and closes the file of this player and challenge, so that it can be replaced.
+    //Its attempts in memory are released
+    void closeFile( const FString & playerId, const FString & challengeId );
+
+    //The nbLastAttempts last attempts of fileName, written in format, without the nbSkipped most recent ones. Called from any thread
+    static void readAttempts( ESWAttemptFileFormat format, const FString & fileName, int nbLastAttempts, FSWAttemptStore & attempts, int nbSkipped = 0 );
+
+    FString FileDataName;
+    ESWAttemptFileFormat FileFormat = ESWAttemptFileFormat::CSV;
+
+private:
+    void onPreLoadMap( const FString & mapName );
+
+    UPROPERTY()
+    FSWCacheSet Caches;
+    TUniquePtr< FSWAttemptWriter > Writer;
+    uint32 NbAttemptsSaved = 0;              //Une lecture en tache de fond commencee avant un nouvel essai n'est pas gardee
+    //Partage avec les lectures en tache de fond, attendues par IsReadyForFinishDestroy
+    TSharedRef< std::atomic< int32 >, ESPMode::ThreadSafe > NbLoadsInFlight = MakeShared< std::atomic< int32 >, ESPMode::ThreadSafe >( 0 );
+    //Plus grande fenetre en cours de lecture par fichier : prefetch ne la relance pas, getAttemptsView l'attend
+    struct FLoadingWindow
+    {
+        int32 NbLastAttempts = 0;
+        uint32 NbAttemptsSavedAtStart = 0;
+        TSharedFuture< FSWAttemptStore > Attempts;
+    };
+    TMap< FString, FLoadingWindow > LoadingWindows;
+    FDelegateHandle PreLoadMapHandle;
+    FDelegateHandle PreExitHandle;
+};
@@ -0,0 +1,163 @@
+#include "SWDDADataManager_LocalLog.h"
+
+#include "SWAttemptLog.h"
+#include "SWDDAAttempt.h"
+
+#include <Async/Async.h>
+#include <Async/ParallelFor.h>
+#include <Misc/CoreDelegates.h>
+#include <UObject/UObjectGlobals.h>
+
+USWDDADataManager_LocalLog::USWDDADataManager_LocalLog()
+{
+    LogDirectory = FPaths::ProjectDir() + "Attempts/";
+    SegmentMaxBytes = FSWAttemptLog::DefaultSegmentMaxBytes;
+    WriteBufferBytes = FSWAttemptLog::DefaultWriteBufferBytes;
+    WriteFlushSeconds = FSWAttemptLog::DefaultFlushSeconds;
+
+    if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+    {
+        //Les essais en attente et l'index sont ecrits avant de quitter ou de changer de niveau
+        PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &USWDDADataManager_LocalLog::onPreLoadMap);
+        PreExitHandle = FCoreDelegates::OnPreExit.AddUObject(this, &USWDDADataManager_LocalLog::flush);
+    }
+}
+
+void USWDDADataManager_LocalLog::BeginDestroy()
+{
+    FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+    FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+
+    Super::BeginDestroy();
+}
+
+bool USWDDADataManager_LocalLog::IsReadyForFinishDestroy()
+{
+    //Les lectures en cours utilisent le log
+    return *NbLoadsInFlight == 0 && Super::IsReadyForFinishDestroy();
+}
+
+void USWDDADataManager_LocalLog::FinishDestroy()
+{
+    //Arrete le thread apres avoir tout ecrit, puis sauve l'index
+    Log.Reset();
+
+    Super::FinishDestroy();
+}
+
+void USWDDADataManager_LocalLog::setDirectory( const FString directory )
+{
+    LogDirectory = directory;
+}
+
+void USWDDADataManager_LocalLog::setCacheBudget( const int64 budgetBytes )
+{
+    Caches.SetBudget(budgetBytes);
+}
+
+FSWAttemptLog & USWDDADataManager_LocalLog::getLog()
+{
+    if (!Log)
+        Log = MakeUnique<FSWAttemptLog>(LogDirectory, SegmentMaxBytes, WriteBufferBytes, WriteFlushSeconds);
+    return *Log;
+}
+
+void USWDDADataManager_LocalLog::addAttempt( const FString playerId, const FString challengeId, USWDDAAttempt * attempt )
+{
+    Caches.AddAttempt(playerId, challengeId, attempt);
+    NbAttemptsSaved++;
+
+    //Copie en memoire seulement : le thread du log l'ecrit
+    getLog().Append(playerId, challengeId, attempt->Thetas.GetData(), attempt->Thetas.Num(), attempt->Result);
+}
+
+TArray<USWDDAAttempt *> USWDDADataManager_LocalLog::getAttempts( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    return FSWAttemptStore::MakeAttempts(getAttemptsView(playerId, challengeId, nbLastAttempts));
+}
+
+FSWAttemptsView USWDDADataManager_LocalLog::getAttemptsView( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    auto & log = getLog();
+    if (nbLastAttempts < 0)
+    {
+        //Tous les essais : trop nombreux pour etre gardes en cache
+        log.ReadLast(playerId, challengeId, nbLastAttempts, AttemptsViewStorage);
+        return AttemptsViewStorage;
+    }
+
+    //Un rafraichissement ne relit pas le log, une fenetre plus grande ne lit que les essais plus anciens
+    auto * cache = Caches.Load(playerId, challengeId, nbLastAttempts, [&log, &playerId, &challengeId]( const int nbSkipped, const int nbAttempts, FSWAttemptStore & attempts )
+    {
+        log.ReadLast(playerId, challengeId, nbAttempts, attempts, nbSkipped);
+    });
+    return cache->GetView(nbLastAttempts);
+}
+
+TFuture<FSWAttemptStore> USWDDADataManager_LocalLog::getAttemptsAsync( const FString playerId, const FString challengeId, const int nbLastAttempts )
+{
+    //Deja en memoire : rien a lire
+    if (Caches.HasWindow(playerId, challengeId, nbLastAttempts))
+        return Super::getAttemptsAsync(playerId, challengeId, nbLastAttempts);
+
+    //Le log est ouvert sur le game thread. Il vit jusqu'a FinishDestroy, qui attend la fin des lectures
+    auto * log = &getLog();
+    const auto nbSavedAtStart = NbAttemptsSaved;
+    auto nbLoadsInFlight = NbLoadsInFlight;
+    TWeakObjectPtr<USWDDADataManager_LocalLog> weakThis(this);
+
+    (*nbLoadsInFlight)++;
+    return Async(EAsyncExecution::ThreadPool, [weakThis, log, nbLoadsInFlight, playerId, challengeId, nbLastAttempts, nbSavedAtStart]()
+    {
+        FSWAttemptStore attempts;
+        log->ReadLast(playerId, challengeId, nbLastAttempts, attempts);
+
+        //Le cache n'est modifie que par le game thread, et seulement si aucun essai n'a ete sauve pendant la lecture
+        AsyncTask(ENamedThreads::GameThread, [weakThis, playerId, challengeId, nbLastAttempts, nbSavedAtStart, attempts]()
+        {
+            if (weakThis.IsValid() && weakThis->NbAttemptsSaved == nbSavedAtStart)
+                weakThis->Caches.OnLoaded(playerId, challengeId, nbLastAttempts, attempts);
+        });
+
+        (*nbLoadsInFlight)--;
+        return attempts;
+    });
+}
+
+void USWDDADataManager_LocalLog::copyAttemptsBatch( const TArray<FSWAttemptsRequest> & requests, TArray<FSWAttemptStore> & attempts )
+{
+    attempts.SetNum(requests.Num());
+
+    TArray<int32> toRead;
+    for (auto index = 0; index < requests.Num(); ++index)
+    {
+        const auto & request = requests[index];
+        if (Caches.HasWindow(request.PlayerId, request.ChallengeId, request.NbLastAttempts))
+            copyAttempts(request.PlayerId, request.ChallengeId, request.NbLastAttempts, attempts[index]);
+        else
+            toRead.Add(index);
+    }
+
+    //Le log ne garde son verrou que pour les copies en memoire : les lectures se font en parallele
+    auto & log = getLog();
+    ParallelFor(toRead.Num(), [&log, &requests, &attempts, &toRead]( const int32 task )
+    {
+        const auto & request = requests[toRead[task]];
+        log.ReadLast(request.PlayerId, request.ChallengeId, request.NbLastAttempts, attempts[toRead[task]]);
+    });
+
+    //Game thread : ce qui a ete lu peut etre garde en memoire
+    for (const auto index : toRead)
+        Caches.OnLoaded(requests[index].PlayerId, requests[index].ChallengeId, requests[index].NbLastAttempts, attempts[index]);
+}
+
+void USWDDADataManager_LocalLog::flush()
+{
+    if (Log)
+        Log->Flush();
+}
+
+void USWDDADataManager_LocalLog::onPreLoadMap( const FString & mapName )
+{
+    flush();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "SWCacheData.h"
+#include "SWDDADataManager.h"
+
+#include <CoreMinimal.h>
+
+#include <atomic>
+
+#include "SWDDADataManager_LocalLog.generated.h"
+
+class FSWAttemptLog;
+
+//Attempts of every player and challenge in a few segment files with an index (see FSWAttemptLog), instead of one file per pair :
+//for servers with many players. The last attempts read are kept in memory (see FSWCacheSet), as for the local files
+UCLASS(BlueprintType)
+class USWDDADataManager_LocalLog : public USWDDADataManager
+{
+    GENERATED_BODY()
+
+public:
+    USWDDADataManager_LocalLog();
+
+    void BeginDestroy() override;
+    //Waits for the reads in the background, without blocking the game thread
+    bool IsReadyForFinishDestroy() override;
+    void FinishDestroy() override;
+
+    //Save all these new attempts for this player and this challenge
+    void addAttempt( FString playerId, FString challengeId, USWDDAAttempt * attempt ) override;
+    //Get nbLastAttempts of this player for this challenge
+    TArray< USWDDAAttempt * > getAttempts( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    //Get nbLastAttempts of this player for this challenge, directly in the cache
+    FSWAttemptsView getAttemptsView( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    //Reads the log on a thread of the pool, then keeps the attempts in the cache on the game thread
+    TFuture< FSWAttemptStore > getAttemptsAsync( FString playerId, FString challengeId, int nbLastAttempts ) override;
+    //The windows that are not in memory are read in parallel
+    void copyAttemptsBatch( const TArray< FSWAttemptsRequest > & requests, TArray< FSWAttemptStore > & attempts ) override;
+
+    //Writes the buffered attempts and saves the index. Done automatically at exit and before loading a map
+    void flush() override;
+
+    //Directory of the log files, to set before the first attempt is saved or read
+    UFUNCTION( BlueprintCallable )
+    void setDirectory( FString directory );
+
+    //Memory allowed for the caches, in bytes. The least recently used caches are released beyond it
+    void setCacheBudget( int64 budgetBytes );
+
+    const FSWCacheStats & getCacheStats() const
+    {
+        return Caches.GetStats();
+    }
+
+    FString LogDirectory;
+    int64 SegmentMaxBytes;
+    int32 WriteBufferBytes;
+    float WriteFlushSeconds;
+
+private:
+    //Ouvert au premier acces, pour ne rien lire pour le CDO
+    FSWAttemptLog & getLog();
+    void onPreLoadMap( const FString & mapName );
+
+    UPROPERTY()
+    FSWCacheSet Caches;
+    TUniquePtr< FSWAttemptLog > Log;
+    uint32 NbAttemptsSaved = 0; //Une lecture en tache de fond commencee avant un nouvel essai n'est pas gardee
+    //Partage avec les lectures en tache de fond, attendues par IsReadyForFinishDestroy
+    TSharedRef< std::atomic< int32 >, ESPMode::ThreadSafe > NbLoadsInFlight = MakeShared< std::atomic< int32 >, ESPMode::ThreadSafe >( 0 );
+    FDelegateHandle PreLoadMapHandle;
+    FDelegateHandle PreExitHandle;
+};
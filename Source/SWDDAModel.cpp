@@ -6,18 +6,47 @@
 #include "SWLogisticRegression.h"
 #include "SWModelLR.h"
 
+#include <Algo/BinarySearch.h>
+#include <Async/Async.h>
+#include <Async/ParallelFor.h>
+#include <UObject/StrongObjectPtr.h>
+
 void USWDDAModel::Init( USWDDADataManager * dataManager, const FString playerId, const FString challengeId )
 {
     DataManager = dataManager;
     PlayerId = playerId;
     ChallengeId = challengeId;
+    LRRandomStream.Initialize( HashCombine( GetTypeHash( playerId ), GetTypeHash( challengeId ) ) );
 
     Algorithm = ESWDDAAlgorithm::DDA_LOGREG;
+    LRLastBetas.Empty();
+    OnlineLR.Reset();
+    DataVersion++;
+    invalidateLogReg();
+    DifficultyCurve.Publish( nullptr, false, DataVersion ); //La courbe d'un autre joueur ne sert plus
+
+    //La fenetre est lue en tache de fond : le premier computeNewDiffParams n'attend pas le fichier
+    if ( DataManager != nullptr )
+        DataManager->prefetch( PlayerId, { ChallengeId }, LRNbLastAttemptsToConsider );
 }
 
 void USWDDAModel::setDdaAlgorithm( const ESWDDAAlgorithm algorithm )
 {
     Algorithm = algorithm;
+    invalidateLogReg();
+}
+
+void USWDDAModel::invalidateLogReg()
+{
+    LRParamsVersion = INDEX_NONE;
+    LRAccuracyVersion = INDEX_NONE;
+    SettingsVersion++;
+}
+
+void USWDDAModel::setAccuracyEstimator( const ESWDDAAccuracyEstimator estimator )
+{
+    AccuracyEstimator = estimator;
+    invalidateLogReg();
 }
 
 void USWDDAModel::setPMInit( const float lastTheta, const bool wonLastTime )
@@ -30,37 +59,132 @@ void USWDDAModel::setPMInit( const float lastTheta, const bool wonLastTime )
 void USWDDAModel::addLastAttempt( USWDDAAttempt * attempt )
 {
     DataManager->addAttempt( PlayerId, ChallengeId, attempt );
-    LRAccuracyUpToDate = false;
+    DataVersion++;
     PMWonLastTime = attempt->Result > 0;
     PMLastTheta = attempt->Thetas[ 0 ];
+
+    //Le modele en ligne n'est amorce qu'au premier computeNewDiffParams en mode DDA_ONLINE_LOGREG
+    if ( OnlineLR.IsInitialized() )
+    {
+        if ( attempt->Thetas.Num() == OnlineLR.GetNbVars() )
+            OnlineLR.Update( attempt->Thetas.GetData(), attempt->Result );
+        else
+            OnlineLR.Reset(); //Le nombre de variables a change : on repartira des donnees enregistrees
+    }
 }
 
-FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const bool doNotUpdateLRAccuracy )
+int32 FSWLogRegFit::NumTasks() const
 {
-    FSWDiffParams diffParams;
-    diffParams.LogRegReady = true;
-    diffParams.AlgorithmWanted = Algorithm;
-    diffParams.LogRegError = ESWDDALogRegError::OK;
+    if ( !Params.LogRegReady )
+        return 0;
 
+    //Les NbRepetitions * NbFolds apprentissages sont independants : un par tache
+    return ( bCrossValidate ? NbRepetitions * NbFolds : 0 ) + 1;
+}
+
+void FSWLogRegFit::RunTask( const int32 task )
+{
+    if ( task == NumTasks() - 1 )
+    {
+        //Using all data to update model
+        try
+        {
+            Betas = SWLogisticRegression::ComputeBetas( Data->IndepVar, Data->DepVar, FailedPivot, ESWNewtonSolver::CHOLESKY, InitialBetas );
+        }
+        catch ( std::exception * e )
+        {
+            //Les erreurs de SWLogisticRegression sont lancees par pointeur : sur un worker, une exception non attrapee termine le process
+            FitError = e->what();
+            delete e;
+        }
+
+        //Leave-one-out approche depuis l'apprentissage sur toutes les donnees : toujours calcule, il ne coute qu'une passe
+        if ( Betas.Num() > 0 && FailedPivot < 0 )
+        {
+            try
+            {
+                AccuracyLOO = SWLogisticRegression::ApproxLOOAccuracy( Data->IndepVar, Data->DepVar, Betas ) / 100.0;
+            }
+            catch ( std::exception * e )
+            {
+                AccuracyLOO = 0;
+                delete e;
+            }
+        }
+        return;
+    }
+
+    const auto & order = FoldOrders[ task / NbFolds ];
+    const auto k = task % NbFolds;
+
+    //Les plis sont des vues sur Data : rien n'est copie
+    FSWDataView train;
+    FSWDataView test;
+    Data->fold( k * ( 100 / NbFolds ), ( k + 1 ) * ( 100 / NbFolds ), &order, train, test );
+
+    try
+    {
+        //Chaque pli part des derniers betas calcules : les donnees d'apprentissage en recouvrent 90%
+        auto failedPivot = -1;
+        auto betas = SWLogisticRegression::ComputeBetas( train, failedPivot, ESWNewtonSolver::CHOLESKY, InitialBetas );
+        FoldAccuracies[ task ] = SWLogisticRegression::PredictiveAccuracy( test, betas ) / 100.0;
+    }
+    catch ( std::exception * e )
+    {
+        FoldAccuracies[ task ] = 0; //Meme resultat que TestModel en cas d'erreur
+        delete e;
+    }
+}
+
+void FSWLogRegFit::Finish()
+{
+    if ( !bCrossValidate )
+        return;
+
+    //Reduction dans l'ordre de la version sequentielle : Accuracy ne depend pas du decoupage en taches
+    Accuracy = 0;
+    for ( int i = 0; i < NbRepetitions; i++ )
+    {
+        float AccuracyNow = 0;
+        for ( int k = 0; k < NbFolds; k++ )
+            AccuracyNow += FoldAccuracies[ i * NbFolds + k ];
+        AccuracyNow /= NbFolds;
+        Accuracy += AccuracyNow;
+    }
+    Accuracy /= NbRepetitions;
+}
+
+void USWDDAModel::updateBatchLogReg( FSWDiffParams & diffParams, const bool doNotUpdateLRAccuracy )
+{
     //Loading data
-    auto attempts = DataManager->getAttempts( PlayerId, ChallengeId, LRNbLastAttemptsToConsider );
+    FSWLogRegFit fit;
+    fit.Params = diffParams;
+    prepareBatchLogReg( fit, DataManager->getAttemptsView( PlayerId, ChallengeId, LRNbLastAttemptsToConsider ), doNotUpdateLRAccuracy );
+
+    ParallelFor( fit.NumTasks(), [&fit]( const int32 task )
+    {
+        fit.RunTask( task );
+    } );
+    fit.Finish();
+
+    applyBatchLogReg( fit, doNotUpdateLRAccuracy );
+    diffParams = fit.Params;
+}
+
+void USWDDAModel::prepareBatchLogReg( FSWLogRegFit & fit, const FSWAttemptsView & attempts, const bool doNotUpdateLRAccuracy )
+{
+    auto & diffParams = fit.Params;
 
     //Data translation for LR
     auto * data = NewObject<USWDataLR>();
-    TArray<TArray<float> > indepVars;
-    TArray<float> depVars;
-    for ( auto * attempt : attempts )
-    {
-        indepVars.Add( attempt->Thetas );
-        depVars.Add( attempt->Result );
-    }
-    data->LoadDataFromList( indepVars, depVars );
+    data->LoadDataFromAttempts( attempts );
+    fit.Data = data;
 
     //On met a jour le dernier theta en fonction des datas si on ne l'a pas deja set
-    if ( indepVars.Num() > 0 && !PMInitialized )
+    if ( attempts.Num() > 0 && attempts.NumThetas > 0 && !PMInitialized )
     {
-        PMLastTheta = indepVars[ indepVars.Num() - 1 ][ 0 ];
-        PMWonLastTime = depVars[ depVars.Num() - 1 ] > 0 ? true : false;
+        PMLastTheta = attempts.GetThetas( attempts.Num() - 1 )[ 0 ];
+        PMWonLastTime = attempts.GetResult( attempts.Num() - 1 ) > 0 ? true : false;
         PMInitialized = true;
     }
 
@@ -76,9 +200,9 @@ FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const b
         //Chekcing wins and fails
         float nbFail = 0;
         float nbWin = 0;
-        for ( auto * attempt : attempts )
+        for ( const auto result : attempts.Results )
         {
-            if ( attempt->Result == 0 )
+            if ( result == 0 )
                 nbFail++;
             else
                 nbWin++;
@@ -97,121 +221,435 @@ FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const b
         }
     }
 
-    if ( diffParams.LogRegReady )
+    if ( !diffParams.LogRegReady )
+        return;
+
+    //Debug.Log("Using " + data.DepVar.Length + " lines to update model");
+
+    //Ten fold cross val, repeated ten times
+    fit.bCrossValidate = !doNotUpdateLRAccuracy && LRAccuracyVersion != DataVersion && AccuracyEstimator == ESWDDAAccuracyEstimator::REPEATED_KFOLD;
+    if ( fit.bCrossValidate )
     {
-        //Debug.Log("Using " + data.DepVar.Length + " lines to update model");
+        //Les melanges restent sur le game thread : seuls des indices de lignes sont permutes, les donnees ne bougent pas.
+        //Tirages dans LRRandomStream : meme resultat quel que soit le decoupage en taches
+        LRFoldOrders.SetNum( FSWLogRegFit::NbRepetitions );
+        for ( int i = 0; i < FSWLogRegFit::NbRepetitions; i++ )
+            data->shuffleOrder( LRFoldOrders[ i ], LRRandomStream );
+
+        fit.FoldOrders = LRFoldOrders;
+        fit.FoldAccuracies.AddZeroed( FSWLogRegFit::NbRepetitions * FSWLogRegFit::NbFolds );
+    }
 
-        if ( !doNotUpdateLRAccuracy && !LRAccuracyUpToDate )
-        {
-            //Ten fold cross val
-            LRAccuracy = 0;
+    //L'ordre des lignes ne change pas le modele : pas de melange pour l'apprentissage sur toutes les donnees
+    fit.InitialBetas = LRLastBetas;
+}
 
-            for ( int i = 0; i < 10; i++ )
-            {
-                float AccuracyNow = 0;
-                data = data->shuffle();
-                int nk = 10;
-                for ( int k = 0; k < nk; k++ )
-                {
-                    auto * dataTrain = NewObject<USWDataLR>();
-                    auto * dataTest = NewObject<USWDataLR>();
-                    data->split( k * ( 100 / nk ), ( k + 1 ) * ( 100 / nk ), dataTrain, dataTest );
-                    LogReg = SWLogisticRegression::ComputeModel( dataTrain );
-                    AccuracyNow += SWLogisticRegression::TestModel( LogReg, dataTest );
-                }
-                AccuracyNow /= nk;
-                LRAccuracy += AccuracyNow;
-            }
-            LRAccuracy /= 10;
+void USWDDAModel::applyBatchLogReg( FSWLogRegFit & fit, const bool doNotUpdateLRAccuracy )
+{
+    auto & diffParams = fit.Params;
+    if ( !diffParams.LogRegReady )
+    {
+        //Pas assez d'essais : rien a evaluer tant qu'aucun essai n'est ajoute
+        LRAccuracyVersion = DataVersion;
+        return;
+    }
 
-            LRAccuracyUpToDate = true;
+    if ( fit.bCrossValidate )
+    {
+        LRAccuracy = fit.Accuracy;
+        LRAccuracyVersion = DataVersion;
+    }
 
-            //Using all data to update model
-            LogReg = SWLogisticRegression::ComputeModel( data );
-            diffParams.NbAttemptsUsedToCompute = data->DepVar.Num();
-        }
-        else
+    LogReg = NewObject<USWModelLR>();
+    LogReg->Betas = MoveTemp( fit.Betas );
+    LogReg->FailedPivot = fit.FailedPivot;
+    if ( !fit.FitError.IsEmpty() )
+        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in ComputeBestBeta: %s" ), *fit.FitError ) );
+    diffParams.NbAttemptsUsedToCompute = fit.Data->DepVar.Num();
+
+    if ( LogReg->isUsable() && LogReg->FailedPivot < 0 )
+    {
+        //Point de depart du prochain calcul (apres addLastAttempt, les donnees ont peu change)
+        LRLastBetas = LogReg->Betas;
+        LRAccuracyLOO = fit.AccuracyLOO;
+
+        if ( !doNotUpdateLRAccuracy && AccuracyEstimator == ESWDDAAccuracyEstimator::APPROX_LOO )
         {
-            data = data->shuffle();
-            LogReg = SWLogisticRegression::ComputeModel( data );
-            diffParams.NbAttemptsUsedToCompute = data->DepVar.Num();
+            LRAccuracy = LRAccuracyLOO;
+            LRAccuracyVersion = DataVersion;
         }
+    }
+
+    if ( LRAccuracy < LRMinimalAccuracy )
+    {
+        //Debug.Log( "LogReg accuracy is under " + LRMinimalAccuracy + ", not using LogReg" );
+        diffParams.LogRegReady = false;
+        diffParams.LogRegError = ESWDDALogRegError::ACCURACY_TOO_LOW;
+    }
 
-        if ( LRAccuracy < LRMinimalAccuracy )
+    if ( !LogReg->isUsable() || LogReg->FailedPivot >= 0 )
+    {
+        //X'WX n'a pas pu etre factorise : les betas ne sont pas fiables, la precision n'est pas evaluable sur ces donnees
+        LRAccuracy = 0;
+        if ( !doNotUpdateLRAccuracy )
+            LRAccuracyVersion = DataVersion;
+        diffParams.LogRegReady = false;
+        diffParams.LogRegError = ESWDDALogRegError::NEWTON_RAPHSON_ERROR;
+    }
+}
+
+void USWDDAModel::updateOnlineLogReg( FSWDiffParams & diffParams )
+{
+    //Premier appel : on rejoue les essais deja enregistres, ensuite addLastAttempt suffit
+    if ( !OnlineLR.IsInitialized() )
+    {
+        auto attempts = DataManager->getAttemptsView( PlayerId, ChallengeId, LRNbLastAttemptsToConsider );
+        if ( attempts.Num() > 0 )
         {
-            //Debug.Log( "LogReg accuracy is under " + LRMinimalAccuracy + ", not using LogReg" );
-            diffParams.LogRegReady = false;
-            diffParams.LogRegError = ESWDDALogRegError::ACCURACY_TOO_LOW;
+            OnlineLR.Init( attempts.NumThetas, OnlineLRPriorVariance, OnlineLRForgettingFactor );
+            for ( auto index = 0; index < attempts.Num(); ++index )
+                OnlineLR.Update( attempts.GetThetas( index ), attempts.GetResult( index ) );
+
+            if ( !PMInitialized && attempts.NumThetas > 0 )
+            {
+                PMLastTheta = attempts.GetThetas( attempts.Num() - 1 )[ 0 ];
+                PMWonLastTime = attempts.GetResult( attempts.Num() - 1 ) > 0;
+                PMInitialized = true;
+            }
         }
+    }
+
+    diffParams.NbAttemptsUsedToCompute = OnlineLR.NbUpdates;
+    //Precision prequentielle toujours a jour (ou pas evaluable tant que les comptes sont insuffisants)
+    LRAccuracyVersion = DataVersion;
+
+    //Memes conditions que la version batch, sur les comptes ponderes par l'oubli
+    if ( OnlineLR.NbUpdates < 10 )
+    {
+        diffParams.LogRegReady = false;
+        diffParams.LogRegError = ESWDDALogRegError::NOT_ENOUGH_SAMPLES;
+        return;
+    }
+
+    if ( OnlineLR.NbFails <= 3 || OnlineLR.NbWins <= 3 )
+    {
+        diffParams.LogRegReady = false;
+        if ( OnlineLR.NbWins <= 3 )
+            diffParams.LogRegError = ESWDDALogRegError::NOT_ENOUGH_WINS;
+        if ( OnlineLR.NbFails <= 3 )
+            diffParams.LogRegError = ESWDDALogRegError::NOT_ENOUGH_FAILS;
+        return;
+    }
 
-        if ( !LogReg->isUsable() )
+    //Precision prequentielle : chaque essai a ete predit avant d'etre appris, pas besoin de validation croisee
+    LRAccuracy = OnlineLR.Accuracy();
+
+    if ( LogReg == nullptr )
+        LogReg = NewObject<USWModelLR>();
+    OnlineLR.GetBetas( LogReg->Betas );
+    LogReg->FailedPivot = -1;
+
+    if ( LRAccuracy < LRMinimalAccuracy )
+    {
+        diffParams.LogRegReady = false;
+        diffParams.LogRegError = ESWDDALogRegError::ACCURACY_TOO_LOW;
+    }
+
+    for ( const auto beta : LogReg->Betas )
+    {
+        if ( !FMath::IsFinite( beta ) )
         {
             LRAccuracy = 0;
+            diffParams.LogRegReady = false;
             diffParams.LogRegError = ESWDDALogRegError::NEWTON_RAPHSON_ERROR;
+            break;
         }
-        else if ( diffParams.LogRegReady )
+    }
+}
+
+void USWDDAModel::checkLogReg( FSWDiffParams & diffParams )
+{
+    //Verifying if LogReg is ok : must be able to work in both ways
+    auto errorSum = 0.f;
+    auto diffTest = 0.1f;
+    TArray<float> pars;
+    pars.AddZeroed( LogReg->Betas.Num() - 1 ); //Les autres variables restent a 0
+    TArray<float> parsForAllDiff;
+    parsForAllDiff.AddZeroed( 8 );
+    FString res;
+    for (auto index = 0; index < 8; ++index)
+    {
+        pars[0] = LogReg->InvPredict(diffTest, pars, 0); //on regarde que la première variable.
+        parsForAllDiff[index] = pars[0];
+        res = "D = " + FString::SanitizeFloat(diffTest) + " par = " + FString::SanitizeFloat(pars[0]);
+        errorSum += FMath::Abs(diffTest - LogReg->Predict(pars)); //On passe dans les deux sens on doit avoir pareil
+        res += " res = " + FString::SanitizeFloat(LogReg->Predict(pars)) + "\n";
+        diffTest += 0.1;
+        //Debug.Log(res);
+    }
+    
+    if (errorSum > 1 || FMath::IsNaN( errorSum ))
+    {
+        //Debug.Log("Model is not solid, error = " + errorSum);
+        LRAccuracy = 0;
+        if (errorSum > 1)
+            diffParams.LogRegError = ESWDDALogRegError::SUM_ERROR_TOO_HIGH;
+        if (FMath::IsNaN( errorSum ))
+            diffParams.LogRegError = ESWDDALogRegError::SUM_ERROR_IS_NAN;
+    }
+
+
+    //Verifying if LogReg is ok : sd of diff predictions in all theta range must not be 0
+    float mean = 0;
+    for (auto index = 0; index < 8; ++index)
+        mean += parsForAllDiff[index];
+    mean /= 8;
+    float sd = 0;
+    for (auto index = 0; index < 8; ++index)
+        sd += (parsForAllDiff[index] - mean) * (parsForAllDiff[index] - mean);
+    sd = FMath::Sqrt(sd);
+
+    //Debug.Log("Model parameter estimation sd = " + sd);
+
+    if (sd < 0.05 || FMath::IsNaN( sd ))
+    {
+        //Debug.Log("Model parameter estimation is always the same : sd=" + sd);
+        LRAccuracy = 0;
+
+        if (sd < 0.05)
+            diffParams.LogRegError = ESWDDALogRegError::SD_PRED_TOO_LOW;
+        if (FMath::IsNaN( sd ))
+            diffParams.LogRegError = ESWDDALogRegError::SD_PRED_IS_NAN;
+    }
+}
+
+bool USWDDAModel::needsLogRegRefresh( const bool doNotUpdateLRAccuracy ) const
+{
+    //Aucun essai depuis le dernier calcul : la regression et sa validation (faite ou impossible) sont toujours bonnes
+    return LRParamsVersion != DataVersion || ( !doNotUpdateLRAccuracy && LRAccuracyVersion != DataVersion );
+}
+
+FSWDiffParams USWDDAModel::makeLogRegParams()
+{
+    FSWDiffParams diffParams;
+    diffParams.LogRegReady = true;
+    diffParams.LogRegError = ESWDDALogRegError::OK;
+    diffParams.NbAttemptsUsedToCompute = 0;
+    return diffParams;
+}
+
+void USWDDAModel::endLogRegRefresh()
+{
+    if ( LRParams.LogRegReady )
+        checkLogReg( LRParams );
+
+    LRParamsVersion = DataVersion;
+    DifficultyCurve.Publish( LogReg, LRParams.LogRegReady, DataVersion );
+}
+
+void USWDDAModel::refreshLogReg( const bool doNotUpdateLRAccuracy )
+{
+    if ( !needsLogRegRefresh( doNotUpdateLRAccuracy ) )
+        return;
+
+    LRParams = makeLogRegParams();
+
+    if ( Algorithm == ESWDDAAlgorithm::DDA_ONLINE_LOGREG )
+        updateOnlineLogReg( LRParams );
+    else
+        updateBatchLogReg( LRParams, doNotUpdateLRAccuracy );
+
+    endLogRegRefresh();
+}
+
+void USWDDAModel::computeNewDiffParamsAsync( const float targetDifficulty, const bool doNotUpdateLRAccuracy, TFunction<void( const FSWDiffParams & )> onComputed )
+{
+    computeNewDiffParamsAsync( targetDifficulty, doNotUpdateLRAccuracy, MoveTemp( onComputed ), 0 );
+}
+
+void USWDDAModel::computeNewDiffParamsAsync( const float targetDifficulty, const bool doNotUpdateLRAccuracy, TFunction<void( const FSWDiffParams & )> onComputed, const int32 nbRetries )
+{
+    //Au-dela, les essais arrivent plus vite que les calculs : on calcule sur le game thread
+    const int32 maxRetries = 3;
+
+    auto job = nbRetries < maxRetries ? prepareLogRegJob( doNotUpdateLRAccuracy ) : nullptr;
+    if ( !job.IsValid() )
+    {
+        const auto diffParams = computeNewDiffParams( targetDifficulty, doNotUpdateLRAccuracy );
+        AsyncTask( ENamedThreads::GameThread, [onComputed, diffParams]()
         {
-            //Verifying if LogReg is ok : must be able to work in both ways
-            auto errorSum = 0.f;
-            auto diffTest = 0.1f;
-            TArray<float> pars;
-            TArray<float> parsForAllDiff;
-            FString res;
-            for (auto index = 0; index < 8; ++index)
-            {
-                pars[0] = LogReg->InvPredict(diffTest, pars, 0); //on regarde que la première variable.
-                parsForAllDiff[index] = pars[0];
-                res = "D = " + FString::SanitizeFloat(diffTest) + " par = " + FString::SanitizeFloat(pars[0]);
-                errorSum += FMath::Abs(diffTest - LogReg->Predict(pars)); //On passe dans les deux sens on doit avoir pareil
-                res += " res = " + FString::SanitizeFloat(LogReg->Predict(pars)) + "\n";
-                diffTest += 0.1;
-                //Debug.Log(res);
-            }
-            
-            if (errorSum > 1 || FMath::IsNaN( errorSum ))
+            onComputed( diffParams );
+        } );
+        return;
+    }
+
+    TWeakObjectPtr<USWDDAModel> weakThis( this );
+    Async( EAsyncExecution::ThreadPool, [job, weakThis, targetDifficulty, doNotUpdateLRAccuracy, onComputed, nbRetries]() mutable
+    {
+        auto & fit = job->Fit;
+        ParallelFor( fit.NumTasks(), [&fit]( const int32 task )
+        {
+            fit.RunTask( task );
+        } );
+        fit.Finish();
+
+        //Le job est libere sur le game thread (TStrongObjectPtr)
+        AsyncTask( ENamedThreads::GameThread, [job = MoveTemp( job ), weakThis, targetDifficulty, doNotUpdateLRAccuracy, onComputed, nbRetries]()
+        {
+            auto * model = weakThis.Get();
+            if ( model == nullptr )
+                return;
+
+            //Un essai ajoute ou un reglage change pendant le calcul : le resultat ne correspond plus au modele
+            if ( !model->applyLogRegJob( *job ) )
             {
-                //Debug.Log("Model is not solid, error = " + errorSum);
-                LRAccuracy = 0;
-                if (errorSum > 1)
-                    diffParams.LogRegError = ESWDDALogRegError::SUM_ERROR_TOO_HIGH;
-                if (FMath::IsNaN( errorSum ))
-                    diffParams.LogRegError = ESWDDALogRegError::SUM_ERROR_IS_NAN;
+                model->computeNewDiffParamsAsync( targetDifficulty, doNotUpdateLRAccuracy, onComputed, nbRetries + 1 );
+                return;
             }
 
+            //Regression a jour : il ne reste que l'exploration et le theta
+            onComputed( model->computeDiffParamsFromCurrentFit( targetDifficulty ) );
+        } );
+    } );
+}
 
-            //Verifying if LogReg is ok : sd of diff predictions in all theta range must not be 0
-            float mean = 0;
-            for (auto index = 0; index < 8; ++index)
-                mean += parsForAllDiff[index];
-            mean /= 8;
-            float sd = 0;
-            for (auto index = 0; index < 8; ++index)
-                sd += (parsForAllDiff[index] - mean) * (parsForAllDiff[index] - mean);
-            sd = FMath::Sqrt(sd);
+TSharedPtr<FSWLogRegJob, ESPMode::ThreadSafe> USWDDAModel::prepareLogRegJob( const bool doNotUpdateLRAccuracy )
+{
+    if ( !needsLogRegRefresh( doNotUpdateLRAccuracy ) || Algorithm == ESWDDAAlgorithm::DDA_ONLINE_LOGREG )
+        return nullptr;
+
+    //Copie des essais et melanges sur le game thread, le calcul ne lit plus que le job
+    auto job = MakeShared<FSWLogRegJob, ESPMode::ThreadSafe>();
+    DataManager->copyAttempts( PlayerId, ChallengeId, LRNbLastAttemptsToConsider, job->Attempts );
+    job->Fit.Params = makeLogRegParams();
+    prepareBatchLogReg( job->Fit, job->Attempts, doNotUpdateLRAccuracy );
+    job->Data.Reset( job->Fit.Data );
+    job->DataVersion = DataVersion;
+    job->SettingsVersion = SettingsVersion;
+    job->bDoNotUpdateLRAccuracy = doNotUpdateLRAccuracy;
+    return job;
+}
 
-            //Debug.Log("Model parameter estimation sd = " + sd);
+bool USWDDAModel::applyLogRegJob( FSWLogRegJob & job )
+{
+    if ( job.DataVersion != DataVersion || job.SettingsVersion != SettingsVersion )
+        return false;
 
-            if (sd < 0.05 || FMath::IsNaN( sd ))
-            {
-                //Debug.Log("Model parameter estimation is always the same : sd=" + sd);
-                LRAccuracy = 0;
+    applyBatchLogReg( job.Fit, job.bDoNotUpdateLRAccuracy );
+    LRParams = job.Fit.Params;
+    endLogRegRefresh();
+    return true;
+}
+
+TArray<FSWDiffParams> USWDDAModel::computeNewDiffParamsBatch( const TArray<FSWDiffRequest> & requests, const bool doNotUpdateLRAccuracy )
+{
+    //Les modeles dont la regression batch est a recalculer (le modele en ligne n'a rien a lire ni a apprendre)
+    TArray<USWDDAModel *> models;
+    for ( const auto & request : requests )
+    {
+        auto * model = request.Model;
+        if ( model != nullptr && model->DataManager != nullptr && model->Algorithm != ESWDDAAlgorithm::DDA_ONLINE_LOGREG
+             && model->needsLogRegRefresh( doNotUpdateLRAccuracy ) )
+        {
+            models.AddUnique( model );
+        }
+    }
 
-                if (sd < 0.05)
-                    diffParams.LogRegError = ESWDDALogRegError::SD_PRED_TOO_LOW;
-                if (FMath::IsNaN( sd ))
-                    diffParams.LogRegError = ESWDDALogRegError::SD_PRED_IS_NAN;
+    //Les fenetres de tous les modeles : un seul appel par data manager
+    TArray<FSWAttemptStore> attempts;
+    attempts.SetNum( models.Num() );
+    TArray<USWDDADataManager *> dataManagers;
+    for ( const auto * model : models )
+        dataManagers.AddUnique( model->DataManager );
+
+    for ( auto * dataManager : dataManagers )
+    {
+        TArray<int32> indices;
+        TArray<FSWAttemptsRequest> attemptsRequests;
+        for ( auto index = 0; index < models.Num(); ++index )
+        {
+            if ( models[ index ]->DataManager == dataManager )
+            {
+                indices.Add( index );
+                attemptsRequests.Add( { models[ index ]->PlayerId, models[ index ]->ChallengeId, models[ index ]->LRNbLastAttemptsToConsider } );
             }
         }
+
+        TArray<FSWAttemptStore> managerAttempts;
+        dataManager->copyAttemptsBatch( attemptsRequests, managerAttempts );
+        for ( auto index = 0; index < indices.Num(); ++index )
+            attempts[ indices[ index ] ] = MoveTemp( managerAttempts[ index ] );
     }
 
+    //Toutes les taches de tous les modeles dans un seul ParallelFor : le temps total est celui du modele le plus long,
+    //pas la somme des modeles
+    TArray<FSWLogRegFit> fits;
+    fits.SetNum( models.Num() );
+    TArray<int32> firstTasks;
+    auto nbTasks = 0;
+    for ( auto index = 0; index < models.Num(); ++index )
+    {
+        fits[ index ].Params = makeLogRegParams();
+        models[ index ]->prepareBatchLogReg( fits[ index ], attempts[ index ], doNotUpdateLRAccuracy );
+
+        firstTasks.Add( nbTasks );
+        nbTasks += fits[ index ].NumTasks();
+    }
+
+    ParallelFor( nbTasks, [&fits, &firstTasks]( const int32 task )
+    {
+        //Modele de la tache : le dernier dont la premiere tache est avant elle (jamais un modele sans tache)
+        const auto index = Algo::UpperBound( firstTasks, task ) - 1;
+        fits[ index ].RunTask( task - firstTasks[ index ] );
+    } );
+
+    for ( auto index = 0; index < models.Num(); ++index )
+    {
+        fits[ index ].Finish();
+        models[ index ]->applyBatchLogReg( fits[ index ], doNotUpdateLRAccuracy );
+        models[ index ]->LRParams = fits[ index ].Params;
+        models[ index ]->endLogRegRefresh();
+    }
+
+    //Regressions a jour : il ne reste que l'exploration et le theta de chaque demande (les modeles en ligne, sans
+    //data manager ou deja a jour n'ont pas ete recalcules, computeNewDiffParams s'en charge)
+    TArray<FSWDiffParams> diffParams;
+    diffParams.Reserve( requests.Num() );
+    for ( const auto & request : requests )
+    {
+        if ( request.Model == nullptr )
+            diffParams.Add( FSWDiffParams() );
+        else if ( models.Contains( request.Model ) )
+            diffParams.Add( request.Model->computeDiffParamsFromCurrentFit( request.TargetDifficulty ) );
+        else
+            diffParams.Add( request.Model->computeNewDiffParams( request.TargetDifficulty, doNotUpdateLRAccuracy ) );
+    }
+
+    return diffParams;
+}
+
+FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const bool doNotUpdateLRAccuracy )
+{
+    refreshLogReg( doNotUpdateLRAccuracy );
+    return computeDiffParamsFromCurrentFit( targetDifficulty );
+}
+
+FSWDiffParams USWDDAModel::computeDiffParamsFromCurrentFit( float targetDifficulty )
+{
+    //Seule l'exploration (tirages aleatoires) est refaite a chaque appel
+    auto diffParams = LRParams;
+    diffParams.AlgorithmWanted = Algorithm;
+
     //Saving params
         diffParams.TargetDiff = targetDifficulty;
         diffParams.LRAccuracy = LRAccuracy;
+        diffParams.LRAccuracyLOO = LRAccuracyLOO;
 
         //Determining theta
+        const auto wantsLogReg = Algorithm == ESWDDAAlgorithm::DDA_LOGREG || Algorithm == ESWDDAAlgorithm::DDA_ONLINE_LOGREG;
 
         //If we want pmdelta or we want log reg but it's not available
-        if ((Algorithm == ESWDDAAlgorithm::DDA_LOGREG && !diffParams.LogRegReady) ||
+        if ((wantsLogReg && !diffParams.LogRegReady) ||
              Algorithm == ESWDDAAlgorithm::DDA_PMDELTA)
         {
             auto delta = PMWonLastTime ? PMDeltaValue : -PMDeltaValue;
@@ -235,12 +673,12 @@ FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const b
         }
 
         //if we want log reg and it's available
-        if (Algorithm == ESWDDAAlgorithm::DDA_LOGREG && diffParams.LogRegReady)
+        if (wantsLogReg && diffParams.LogRegReady)
         {
             diffParams.TargetDiffWithExplo = targetDifficulty + FMath::RandRange(-LRExplo, LRExplo);
             diffParams.TargetDiffWithExplo = FMath::Min(1.0f, FMath::Max(0.f, static_cast< float >( diffParams.TargetDiffWithExplo )));
             diffParams.Theta = LogReg->InvPredict(1.0f - diffParams.TargetDiffWithExplo);
-            diffParams.AlgorithmActuallyUsed = ESWDDAAlgorithm::DDA_LOGREG;
+            diffParams.AlgorithmActuallyUsed = Algorithm;
         }
 
         //if we want random log reg and it's available
@@ -290,15 +728,21 @@ FSWDiffParams USWDDAModel::computeNewDiffParams( float targetDifficulty, const b
 
 bool USWDDAModel::checkDataAgainst( TArray< USWDDAAttempt * > & attempts ) const
 {
-    auto attemptsSaved = DataManager->getAttempts( PlayerId, ChallengeId, LRNbLastAttemptsToConsider );
+    auto attemptsSaved = DataManager->getAttemptsView( PlayerId, ChallengeId, LRNbLastAttemptsToConsider );
+
+    //Moins d'essais enregistres que la fenetre : on compare les derniers de chaque cote
+    const auto nbSaved = FMath::Min( attemptsSaved.Num(), LRNbLastAttemptsToConsider );
+    if ( attempts.Num() < nbSaved )
+        return false;
 
     auto isSame = true;
     auto nbCheck = 0;
     for ( auto index = 0; index < attempts.Num(); ++index )
     {
-        if ( index >= attempts.Num() - LRNbLastAttemptsToConsider )
+        if ( index >= attempts.Num() - nbSaved )
         {
-            if ( !attempts[ index ]->IsSame( attemptsSaved[ index - ( attempts.Num() - LRNbLastAttemptsToConsider ) ] ) )
+            const auto indexSaved = index - ( attempts.Num() - nbSaved );
+            if ( !attempts[ index ]->IsSame( attemptsSaved.GetThetas( indexSaved ), attemptsSaved.NumThetas, attemptsSaved.GetResult( indexSaved ) ) )
             {
                 //Debug.LogError( "Attempt " + index + " is corrupted" );
                 isSame = false;
@@ -2,10 +2,18 @@
 
 #include <CoreMinimal.h>
 
+#include <UObject/StrongObjectPtr.h>
+
+#include "SWAttemptStore.h"
+#include "SWDifficultyCurve.h"
+#include "SWOnlineLR.h"
+
 #include "SWDDAModel.generated.h"
 
 class USWDDADataManager;
 class USWDDAAttempt;
+class USWDataLR;
+class USWDDAModel;
 class USWModelLR;
 
 UENUM(BlueprintType)
@@ -14,7 +22,15 @@ enum class ESWDDAAlgorithm : uint8
     DDA_LOGREG, //Utilise la regression logistique (si modèle calibré, sinon PM_DELTA)
     DDA_PMDELTA, //Si on gagne, theta monte, si on perds, theta descend
     DDA_RANDOM_THETA, //Choisit un theta random
-    DDA_RANDOM_LOGREG //Choisit une diff random et en déduit le theta avec la logreg (sinon on fait random theta)
+    DDA_RANDOM_LOGREG, //Choisit une diff random et en déduit le theta avec la logreg (sinon on fait random theta)
+    DDA_ONLINE_LOGREG //Comme DDA_LOGREG, mais la regression est mise a jour a chaque essai (bayesien en ligne) au lieu d'etre recalculee
+};
+
+UENUM(BlueprintType)
+enum class ESWDDAAccuracyEstimator : uint8
+{
+    REPEATED_KFOLD, //Validation croisee 10 plis repetee 10 fois : 100 apprentissages
+    APPROX_LOO //Leave-one-out approche a partir de l'apprentissage sur toutes les donnees : une passe de plus
 };
 
 UENUM(BlueprintType)
@@ -48,6 +64,8 @@ struct FSWDiffParams
     UPROPERTY(BlueprintReadOnly)
     float LRAccuracy;
     UPROPERTY(BlueprintReadOnly)
+    float LRAccuracyLOO; //Toujours calculee (meme si l'estimateur choisi est REPEATED_KFOLD), pour comparer
+    UPROPERTY(BlueprintReadOnly)
     float Theta;
     UPROPERTY(BlueprintReadOnly)
     int NbAttemptsUsedToCompute;
@@ -59,6 +77,58 @@ struct FSWDiffParams
     TArray<float> Betas;
 };
 
+//A model and the difficulty wanted for it, see USWDDAModel::computeNewDiffParamsBatch
+USTRUCT(BlueprintType)
+struct FSWDiffRequest
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite)
+    USWDDAModel * Model = nullptr;
+    UPROPERTY(BlueprintReadWrite)
+    float TargetDifficulty = 0.5f;
+};
+
+//Calcul de la regression batch d'un modele en trois temps : preparation sur le game thread (lecture des essais, melanges),
+//apprentissages sur n'importe quel thread (une tache par pli et une pour toutes les donnees), puis application sur le game thread
+struct FSWLogRegFit
+{
+    static constexpr int32 NbRepetitions = 10;
+    static constexpr int32 NbFolds = 10;
+
+    //Nombre de taches de l'apprentissage (0 si la regression n'est pas prete)
+    int32 NumTasks() const;
+    //Un pli de la validation croisee, ou la derniere tache : toutes les donnees puis le leave-one-out
+    void RunTask( int32 task );
+    //Precision de la validation croisee, dans l'ordre de la version sequentielle
+    void Finish();
+
+    FSWDiffParams Params;
+    USWDataLR * Data = nullptr;
+    bool bCrossValidate = false;
+    TArray<TArray<int32> > FoldOrders; //Copie : le modele peut refaire ses melanges pendant un calcul en tache de fond
+    TArray<float> InitialBetas;
+
+    TArray<float> FoldAccuracies;
+    float Accuracy = 0;
+    TArray<float> Betas;
+    int FailedPivot = -1;
+    float AccuracyLOO = 0;
+    FString FitError;
+};
+
+//Regression calculee hors du game thread (computeNewDiffParamsAsync, USWDDAScheduler) : preparee puis appliquee par le modele
+//sur le game thread, les taches de Fit peuvent tourner sur n'importe quel thread
+struct FSWLogRegJob
+{
+    FSWAttemptStore Attempts;
+    FSWLogRegFit Fit;
+    TStrongObjectPtr<USWDataLR> Data; //Garde les donnees en vie meme si le modele est detruit pendant le calcul
+    uint32 DataVersion = 0;
+    uint32 SettingsVersion = 0;
+    bool bDoNotUpdateLRAccuracy = false;
+};
+
 UCLASS(Blueprintable)
 class SWARMS_API USWDDAModel : public UObject
 {
@@ -77,6 +147,12 @@ public:
     UFUNCTION(BlueprintCallable)
     void setDdaAlgorithm( ESWDDAAlgorithm algorithm );
 
+    /**
+    * Chooses how the log reg accuracy compared to LRMinimalAccuracy is estimated (see enum description)
+    */
+    UFUNCTION(BlueprintCallable)
+    void setAccuracyEstimator( ESWDDAAccuracyEstimator estimator );
+
     /**
     * Permet de déterminer un point de départ. L'algo pmdelta
     * va partir de la pour augmenter ou diminuer la difficulté
@@ -97,6 +173,47 @@ public:
     UFUNCTION(BlueprintCallable)
     FSWDiffParams computeNewDiffParams(float targetDifficulty, bool doNotUpdateLRAccuracy = false);
 
+    /**
+    * Same as computeNewDiffParams, without blocking the game thread : the attempts are copied, the regression is computed
+    * on a worker thread and onComputed is called on the game thread. If an attempt is added or a setting changes
+    * during the computation, the result is not kept and the computation starts again on the new data
+    */
+    void computeNewDiffParamsAsync( float targetDifficulty, bool doNotUpdateLRAccuracy, TFunction<void( const FSWDiffParams & )> onComputed );
+
+    /**
+    * Game thread : copies the attempts and prepares the regression, whose tasks (Fit.RunTask) can then run on any thread.
+    * nullptr if there is nothing to compute off the game thread (regression up to date, online algorithm)
+    */
+    TSharedPtr<FSWLogRegJob, ESPMode::ThreadSafe> prepareLogRegJob( bool doNotUpdateLRAccuracy );
+
+    /**
+    * Game thread : keeps the result of a finished job (after Fit.Finish). Returns false, and changes nothing,
+    * if an attempt was added or a setting changed since prepareLogRegJob
+    */
+    bool applyLogRegJob( FSWLogRegJob & job );
+
+    /**
+    * Game thread : computeNewDiffParams without refreshing the regression, for callers that just applied a job
+    * (exploration and theta from the current fit only)
+    */
+    FSWDiffParams computeDiffParamsFromCurrentFit( float targetDifficulty );
+
+    /**
+    * computeNewDiffParams for many models at once (lobby formation) : the attempts of all the models are read with one call
+    * per data manager, then every regression is computed in parallel. The result i is for requests[ i ]
+    */
+    UFUNCTION(BlueprintCallable)
+    static TArray<FSWDiffParams> computeNewDiffParamsBatch( const TArray<FSWDiffRequest> & requests, bool doNotUpdateLRAccuracy = false );
+
+    /**
+    * Curve of the last regression computed (by computeNewDiffParams, the async version or the batch). Can be read
+    * from any thread (AI, spawning, UI) while the game thread computes the next one
+    */
+    const FSWDifficultyCurveSnapshot & getDifficultyCurve() const
+    {
+        return DifficultyCurve;
+    }
+
     UFUNCTION(BlueprintPure)
     bool checkDataAgainst( UPARAM(ref) TArray<USWDDAAttempt *> & attempts) const;
 
@@ -104,8 +221,19 @@ public:
     FString PlayerId;
     FString ChallengeId;
 
+    //Incremente a chaque nouvel essai : la regression n'est recalculee que si elle a change
+    uint32 DataVersion = 0;
+    //Incremente a chaque changement de reglage de la regression
+    uint32 SettingsVersion = 0;
+
     //Log reg model
     float LRAccuracy = 0;
+    float LRAccuracyLOO = 0;
+    ESWDDAAccuracyEstimator AccuracyEstimator = ESWDDAAccuracyEstimator::REPEATED_KFOLD;
+
+    //Online log reg model (DDA_ONLINE_LOGREG)
+    float OnlineLRForgettingFactor = 1.0f - 1.0f / 150; //Memoire d'environ 150 essais, comme la fenetre de la version batch
+    float OnlineLRPriorVariance = 100.0f;
     
     //PMDelta model
     bool PMInitialized = false;
@@ -118,6 +246,32 @@ public:
     ESWDDAAlgorithm Algorithm;
 
 private:
+    //Met a jour LogReg et LRParams si DataVersion a change depuis le dernier calcul
+    void refreshLogReg( bool doNotUpdateLRAccuracy );
+    bool needsLogRegRefresh( bool doNotUpdateLRAccuracy ) const;
+    //LRParams avant le calcul de la regression
+    static FSWDiffParams makeLogRegParams();
+    void endLogRegRefresh();
+
+    //Force le prochain refreshLogReg a tout recalculer (changement de reglage)
+    void invalidateLogReg();
+
+    //computeNewDiffParamsAsync, nbRetries fois deja relance parce que le modele avait change pendant le calcul
+    void computeNewDiffParamsAsync( float targetDifficulty, bool doNotUpdateLRAccuracy, TFunction<void( const FSWDiffParams & )> onComputed, int32 nbRetries );
+
+    //Regression sur les LRNbLastAttemptsToConsider derniers essais (validation croisee + Newton-Raphson)
+    void updateBatchLogReg( FSWDiffParams & diffParams, bool doNotUpdateLRAccuracy );
+    //Game thread : donnees, verifications et melanges de updateBatchLogReg
+    void prepareBatchLogReg( FSWLogRegFit & fit, const FSWAttemptsView & attempts, bool doNotUpdateLRAccuracy );
+    //Game thread : resultats de l'apprentissage dans LogReg, LRAccuracy et fit.Params
+    void applyBatchLogReg( FSWLogRegFit & fit, bool doNotUpdateLRAccuracy );
+
+    //Lecture du modele mis a jour dans addLastAttempt
+    void updateOnlineLogReg( FSWDiffParams & diffParams );
+
+    //Verifie que la regression fonctionne dans les deux sens et discrimine sur tout l'intervalle de theta
+    void checkLogReg( FSWDiffParams & diffParams );
+
     //Settings Data
     UPROPERTY()
     USWDDADataManager * DataManager;
@@ -127,6 +281,13 @@ private:
     USWModelLR * LogReg;
     const float LRMinimalAccuracy = 0.6;
     float LRExplo = 0.05f;
-    bool LRAccuracyUpToDate = false;
     const int LRNbLastAttemptsToConsider = 150;
+    FRandomStream LRRandomStream; //Melanges de la validation croisee, initialise par Init a partir du joueur et du challenge
+    TArray<TArray<int32> > LRFoldOrders; //Une permutation des lignes par repetition, gardee d'un calcul a l'autre
+    TArray<float> LRLastBetas; //Betas du dernier calcul sur toutes les donnees, point de depart des calculs suivants
+    FSWOnlineLR OnlineLR;
+    FSWDiffParams LRParams; //Etat de la regression (pret, erreur, nombre d'essais) au dernier refreshLogReg
+    int64 LRParamsVersion = INDEX_NONE; //DataVersion de LRParams
+    int64 LRAccuracyVersion = INDEX_NONE; //DataVersion de LRAccuracy : evaluee, ou pas evaluable (trop peu d'essais, pivot rate)
+    FSWDifficultyCurveSnapshot DifficultyCurve; //Publiee par endLogRegRefresh
 };
\ No newline at end of file
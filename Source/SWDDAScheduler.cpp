@@ -0,0 +1,306 @@
+#include "SWDDAScheduler.h"
+
+#include <Async/Async.h>
+#include <HAL/Event.h>
+#include <HAL/PlatformMisc.h>
+#include <HAL/PlatformProcess.h>
+#include <HAL/PlatformTime.h>
+#include <HAL/RunnableThread.h>
+#include <Misc/ScopeExit.h>
+#include <Misc/ScopeLock.h>
+
+FSWDDAWorkerPool::FWorker::FWorker( FSWDDAWorkerPool & pool, const int32 index )
+    : Pool( pool )
+{
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool( false );
+    Thread = FRunnableThread::Create( this, *FString::Printf( TEXT( "SWDDAWorker%d" ), index ), 0, TPri_BelowNormal );
+}
+
+FSWDDAWorkerPool::FWorker::~FWorker()
+{
+    if ( Thread != nullptr )
+    {
+        Thread->Kill( true );
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    FPlatformProcess::ReturnSynchEventToPool( WakeEvent );
+    WakeEvent = nullptr;
+}
+
+uint32 FSWDDAWorkerPool::FWorker::Run()
+{
+    while ( !bStopping )
+    {
+        //Reveille par Add, le delai ne sert que de filet de securite
+        if ( !Pool.RunNextTask() )
+            WakeEvent->Wait( 100 );
+    }
+
+    return 0;
+}
+
+void FSWDDAWorkerPool::FWorker::Stop()
+{
+    bStopping = true;
+    WakeEvent->Trigger();
+}
+
+FSWDDAWorkerPool::FSWDDAWorkerPool( const int32 nbWorkers, TFunction<void( FJobPtr )> onJobDone )
+    : OnJobDone( MoveTemp( onJobDone ) )
+{
+    for ( auto index = 0; index < FMath::Max( nbWorkers, 1 ); ++index )
+        Workers.Add( MakeUnique<FWorker>( *this, index ) );
+}
+
+FSWDDAWorkerPool::~FSWDDAWorkerPool()
+{
+    //Kill attend la fin de la tache en cours
+    Workers.Reset();
+}
+
+void FSWDDAWorkerPool::Add( const FJobPtr & job )
+{
+    {
+        FScopeLock lock( &QueueLock );
+        ( job->Priority == ESWDDAPriority::GAMEPLAY ? GameplayQueue : BackgroundQueue ).Add( job );
+    }
+
+    for ( const auto & worker : Workers )
+        worker->WakeEvent->Trigger();
+}
+
+void FSWDDAWorkerPool::Promote( const FJobPtr & job )
+{
+    FScopeLock lock( &QueueLock );
+    job->Priority = ESWDDAPriority::GAMEPLAY;
+
+    //Toutes ses taches deja distribuees : il n'est plus dans la file
+    if ( BackgroundQueue.Remove( job ) > 0 )
+        GameplayQueue.Add( job );
+}
+
+bool FSWDDAWorkerPool::RunNextTask()
+{
+    FJobPtr job;
+    int32 task;
+    {
+        FScopeLock lock( &QueueLock );
+        auto & queue = GameplayQueue.Num() > 0 ? GameplayQueue : BackgroundQueue;
+        if ( queue.Num() == 0 )
+            return false;
+
+        //Les workers se partagent les taches du premier job : les plis d'une regression de gameplay
+        //ne laissent jamais la place a une validation croisee en arriere-plan
+        job = queue[ 0 ];
+        task = job->NextTask++;
+        if ( task == job->NbTasks - 1 )
+            queue.RemoveAt( 0 );
+    }
+
+    job->LogReg->Fit.RunTask( task );
+
+    if ( ++job->NbTasksDone == job->NbTasks )
+    {
+        job->LogReg->Fit.Finish();
+        OnJobDone( MoveTemp( job ) );
+    }
+
+    return true;
+}
+
+void USWDDAScheduler::Initialize( FSubsystemCollectionBase & collection )
+{
+    Super::Initialize( collection );
+
+    //Un worker par coeur en plus des workers du task graph (ParallelFor) surchargerait le CPU
+    const auto nbWorkers = NbWorkers > 0 ? NbWorkers : FMath::Max( FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 4, 1 );
+
+    TWeakObjectPtr<USWDDAScheduler> weakThis( this );
+    Pool = MakeUnique<FSWDDAWorkerPool>( nbWorkers, [weakThis]( FSWDDAWorkerPool::FJobPtr job )
+    {
+        AsyncTask( ENamedThreads::GameThread, [weakThis, job = MoveTemp( job )]()
+        {
+            if ( auto * scheduler = weakThis.Get() )
+                scheduler->onJobDone( job );
+        } );
+    } );
+}
+
+void USWDDAScheduler::Deinitialize()
+{
+    //Attend les taches en cours, les jobs en file ne seront plus calcules par les workers
+    Pool.Reset();
+
+    //Leurs requetes sont servies ici, sur le game thread : chaque appelant recoit une reponse.
+    //Les jobs termines dont onJobDone n'est pas encore passe n'y passeront plus (ils ne sont plus dans Jobs)
+    auto jobs = MoveTemp( Jobs );
+    for ( const auto & job : jobs )
+    {
+        auto * model = job->Model.Get();
+        for ( const auto & request : job->Requests )
+        {
+            if ( model != nullptr )
+                deliver( model, request, job->LogReg->bDoNotUpdateLRAccuracy );
+            else if ( request.OnComputed )
+                request.OnComputed( FSWDiffParams() );
+        }
+        job->LogReg->Data.Reset();
+    }
+
+    Super::Deinitialize();
+}
+
+void USWDDAScheduler::requestDiffParams( USWDDAModel * model, const float targetDifficulty, const ESWDDAPriority priority, TFunction<void( const FSWDiffParams & )> onComputed, const bool doNotUpdateLRAccuracy )
+{
+    Stats.Requests++;
+    addRequest( model, { targetDifficulty, MoveTemp( onComputed ), FPlatformTime::Seconds(), priority }, doNotUpdateLRAccuracy );
+}
+
+void USWDDAScheduler::scheduleDiffParams( USWDDAModel * model, const float targetDifficulty, const ESWDDAPriority priority, FSWOnDiffParamsReady onComputed )
+{
+    requestDiffParams( model, targetDifficulty, priority, [onComputed]( const FSWDiffParams & diffParams )
+    {
+        onComputed.ExecuteIfBound( diffParams );
+    } );
+}
+
+void USWDDAScheduler::requestRefresh( USWDDAModel * model )
+{
+    Stats.Requests++;
+    addRequest( model, { 0, nullptr, FPlatformTime::Seconds(), ESWDDAPriority::BACKGROUND }, false );
+}
+
+FSWDDASchedulerStats USWDDAScheduler::getStats() const
+{
+    auto stats = Stats;
+    stats.QueuedJobs = Jobs.Num();
+    stats.QueuedGameplayJobs = 0;
+    for ( const auto & job : Jobs )
+        stats.QueuedGameplayJobs += job->Priority == ESWDDAPriority::GAMEPLAY;
+
+    const auto gameplay = static_cast<int32>( ESWDDAPriority::GAMEPLAY );
+    const auto background = static_cast<int32>( ESWDDAPriority::BACKGROUND );
+    stats.GameplayLatencyMs = NbLatencies[ gameplay ] > 0 ? LatencySum[ gameplay ] / NbLatencies[ gameplay ] * 1000 : 0;
+    stats.BackgroundLatencyMs = NbLatencies[ background ] > 0 ? LatencySum[ background ] / NbLatencies[ background ] * 1000 : 0;
+    return stats;
+}
+
+void USWDDAScheduler::addRequest( USWDDAModel * model, FSWDDAWorkerPool::FRequest && request, const bool doNotUpdateLRAccuracy, const bool bRestarted )
+{
+    if ( model == nullptr )
+    {
+        if ( request.OnComputed )
+            request.OnComputed( FSWDiffParams() );
+        return;
+    }
+
+    //Plus de workers (apres Deinitialize) : calcul direct
+    if ( !Pool )
+    {
+        deliver( model, request, doNotUpdateLRAccuracy );
+        return;
+    }
+
+    //Meme modele, memes donnees et memes reglages : la regression en cours sert aussi a cette requete
+    //(une regression qui met a jour la precision sert aussi a celles qui ne la demandent pas, pas l'inverse)
+    for ( const auto & job : Jobs )
+    {
+        if ( job->Model.Get() == model && job->LogReg->DataVersion == model->DataVersion && job->LogReg->SettingsVersion == model->SettingsVersion
+             && ( !job->LogReg->bDoNotUpdateLRAccuracy || doNotUpdateLRAccuracy ) )
+        {
+            if ( request.Priority == ESWDDAPriority::GAMEPLAY && job->Priority == ESWDDAPriority::BACKGROUND )
+                Pool->Promote( job );
+
+            job->Requests.Add( MoveTemp( request ) );
+            if ( !bRestarted )
+                Stats.CoalescedRequests++;
+            return;
+        }
+    }
+
+    auto logReg = model->prepareLogRegJob( doNotUpdateLRAccuracy );
+    if ( !logReg.IsValid() )
+    {
+        //Regression a jour ou modele en ligne : il ne reste que l'exploration, rien a confier aux workers
+        deliver( model, request, doNotUpdateLRAccuracy );
+        return;
+    }
+
+    auto job = MakeShared<FSWDDAWorkerPool::FJob, ESPMode::ThreadSafe>();
+    job->Model = model;
+    job->LogReg = MoveTemp( logReg );
+    job->NbTasks = job->LogReg->Fit.NumTasks();
+    job->Priority = request.Priority;
+    job->Requests.Add( MoveTemp( request ) );
+
+    if ( job->NbTasks == 0 )
+    {
+        //Pas assez d'essais pour une regression
+        job->LogReg->Fit.Finish();
+        Jobs.Add( job );
+        onJobDone( job );
+        return;
+    }
+
+    Jobs.Add( job );
+    Pool->Add( job );
+}
+
+void USWDDAScheduler::onJobDone( const FSWDDAWorkerPool::FJobPtr & job )
+{
+    //Deja servi par Deinitialize
+    if ( Jobs.Remove( job ) == 0 )
+        return;
+
+    //Le dernier worker peut encore tenir le job : les donnees sont liberees ici, sur le game thread
+    ON_SCOPE_EXIT
+    {
+        job->LogReg->Data.Reset();
+    };
+
+    auto requests = MoveTemp( job->Requests );
+
+    auto * model = job->Model.Get();
+    if ( model == nullptr )
+    {
+        for ( const auto & request : requests )
+        {
+            if ( request.OnComputed )
+                request.OnComputed( FSWDiffParams() );
+        }
+        return;
+    }
+
+    //Un essai ajoute ou un reglage change pendant le calcul : les requetes repartent sur les donnees actuelles
+    if ( !model->applyLogRegJob( *job->LogReg ) )
+    {
+        Stats.JobsRestarted++;
+        for ( auto & request : requests )
+            addRequest( model, MoveTemp( request ), job->LogReg->bDoNotUpdateLRAccuracy, true );
+        return;
+    }
+
+    //Regression appliquee : les requetes n'ont plus que l'exploration a calculer
+    Stats.JobsCompleted++;
+    for ( const auto & request : requests )
+        deliver( model, request, job->LogReg->bDoNotUpdateLRAccuracy, true );
+}
+
+void USWDDAScheduler::deliver( USWDDAModel * model, const FSWDDAWorkerPool::FRequest & request, const bool doNotUpdateLRAccuracy, const bool bFitApplied )
+{
+    const auto latency = FPlatformTime::Seconds() - request.StartTime;
+    const auto priority = static_cast<int32>( request.Priority );
+    LatencySum[ priority ] += latency;
+    NbLatencies[ priority ]++;
+    Stats.MaxLatencyMs = FMath::Max( Stats.MaxLatencyMs, static_cast<float>( latency * 1000 ) );
+
+    if ( !request.OnComputed )
+        return;
+
+    if ( bFitApplied )
+        request.OnComputed( model->computeDiffParamsFromCurrentFit( request.TargetDifficulty ) );
+    else
+        request.OnComputed( model->computeNewDiffParams( request.TargetDifficulty, doNotUpdateLRAccuracy ) );
+}
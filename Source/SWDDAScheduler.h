@@ -0,0 +1,161 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <HAL/Runnable.h>
+#include <Subsystems/GameInstanceSubsystem.h>
+
+#include "SWDDAModel.h"
+
+#include <atomic>
+
+#include "SWDDAScheduler.generated.h"
+
+class FEvent;
+class FRunnableThread;
+
+UENUM(BlueprintType)
+enum class ESWDDAPriority : uint8
+{
+    GAMEPLAY,  //Requete du jeu en cours : servie avant tout le reste
+    BACKGROUND //Rafraichissement de la validation croisee, UI...
+};
+
+DECLARE_DYNAMIC_DELEGATE_OneParam( FSWOnDiffParamsReady, const FSWDiffParams &, DiffParams );
+
+USTRUCT(BlueprintType)
+struct FSWDDASchedulerStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly)
+    int32 QueuedJobs = 0; //Regressions en attente d'un worker ou en cours de calcul
+    UPROPERTY(BlueprintReadOnly)
+    int32 QueuedGameplayJobs = 0;
+    UPROPERTY(BlueprintReadOnly)
+    int32 Requests = 0;
+    UPROPERTY(BlueprintReadOnly)
+    int32 CoalescedRequests = 0; //Servies par la regression d'une requete precedente sur les memes donnees
+    UPROPERTY(BlueprintReadOnly)
+    int32 JobsCompleted = 0;
+    UPROPERTY(BlueprintReadOnly)
+    int32 JobsRestarted = 0; //Le modele a change pendant le calcul
+    UPROPERTY(BlueprintReadOnly)
+    float GameplayLatencyMs = 0; //Moyenne, de la requete au resultat
+    UPROPERTY(BlueprintReadOnly)
+    float BackgroundLatencyMs = 0;
+    UPROPERTY(BlueprintReadOnly)
+    float MaxLatencyMs = 0;
+};
+
+//Worker threads of USWDDAScheduler : each worker runs the next task (a cross validation fold or the full fit)
+//of the first job of the gameplay queue, or of the background queue if it is empty
+class FSWDDAWorkerPool
+{
+public:
+    struct FRequest
+    {
+        float TargetDifficulty;
+        TFunction<void( const FSWDiffParams & )> OnComputed; //Vide pour un rafraichissement
+        double StartTime;
+        ESWDDAPriority Priority;
+    };
+
+    struct FJob
+    {
+        TWeakObjectPtr<USWDDAModel> Model;
+        TSharedPtr<FSWLogRegJob, ESPMode::ThreadSafe> LogReg;
+        int32 NbTasks = 0;
+        ESWDDAPriority Priority = ESWDDAPriority::BACKGROUND; //Game thread
+        TArray<FRequest> Requests;                             //Game thread
+        std::atomic<int32> NextTask { 0 };
+        std::atomic<int32> NbTasksDone { 0 };
+    };
+
+    using FJobPtr = TSharedPtr<FJob, ESPMode::ThreadSafe>;
+
+    //onJobDone is called by the worker that finished the last task of a job, after Fit.Finish
+    FSWDDAWorkerPool( int32 nbWorkers, TFunction<void( FJobPtr )> onJobDone );
+    //Waits for the tasks in progress, the jobs still queued are dropped
+    ~FSWDDAWorkerPool();
+
+    void Add( const FJobPtr & job );
+    //Moves a background job to the gameplay queue if it still has tasks to hand out
+    void Promote( const FJobPtr & job );
+
+private:
+    class FWorker : public FRunnable
+    {
+    public:
+        FWorker( FSWDDAWorkerPool & pool, int32 index );
+        ~FWorker();
+
+        uint32 Run() override;
+        void Stop() override;
+
+        FEvent * WakeEvent = nullptr;
+
+    private:
+        FSWDDAWorkerPool & Pool;
+        FRunnableThread * Thread = nullptr;
+        std::atomic<bool> bStopping { false };
+    };
+
+    //Worker : false if there is no task to run
+    bool RunNextTask();
+
+    FCriticalSection QueueLock;
+    TArray<FJobPtr> GameplayQueue;
+    TArray<FJobPtr> BackgroundQueue;
+
+    TFunction<void( FJobPtr )> OnJobDone;
+    TArray<TUniquePtr<FWorker> > Workers;
+};
+
+//Central scheduler for the difficulty computations of every model, instead of each model fitting when it is asked.
+//Requests for a model whose data and settings have not changed share the same regression, gameplay requests are served
+//before background ones, and the regressions are computed by a pool of worker threads owned by the scheduler.
+//Every request gets an answer : the ones still queued when the scheduler is deinitialized are computed on the game thread,
+//and a request for a destroyed model receives FSWDiffParams() (LogRegReady false)
+UCLASS(Config=Game)
+class SWARMS_API USWDDAScheduler : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    void Initialize( FSubsystemCollectionBase & collection ) override;
+    void Deinitialize() override;
+
+    //Game thread : onComputed is called on the game thread with the result of model->computeNewDiffParams( targetDifficulty )
+    void requestDiffParams( USWDDAModel * model, float targetDifficulty, ESWDDAPriority priority, TFunction<void( const FSWDiffParams & )> onComputed, bool doNotUpdateLRAccuracy = false );
+
+    //Blueprint version of requestDiffParams
+    UFUNCTION(BlueprintCallable)
+    void scheduleDiffParams( USWDDAModel * model, float targetDifficulty, ESWDDAPriority priority, FSWOnDiffParamsReady onComputed );
+
+    //Recomputes the regression of the model and its cross validation in the background, if its data changed
+    UFUNCTION(BlueprintCallable)
+    void requestRefresh( USWDDAModel * model );
+
+    UFUNCTION(BlueprintPure)
+    FSWDDASchedulerStats getStats() const;
+
+    //Number of worker threads, read from the config ([/Script/Swarms.SWDDAScheduler] in DefaultGame.ini) before Initialize.
+    //0 : a quarter of the cores, since each fit also runs its folds with ParallelFor on the task graph workers
+    UPROPERTY(Config)
+    int32 NbWorkers = 0;
+
+private:
+    //A restarted request was already counted when it was made
+    void addRequest( USWDDAModel * model, FSWDDAWorkerPool::FRequest && request, bool doNotUpdateLRAccuracy, bool bRestarted = false );
+    void onJobDone( const FSWDDAWorkerPool::FJobPtr & job );
+    //bFitApplied : le job du modele vient d'etre applique, la regression n'est pas recalculee
+    void deliver( USWDDAModel * model, const FSWDDAWorkerPool::FRequest & request, bool doNotUpdateLRAccuracy, bool bFitApplied = false );
+
+    TUniquePtr<FSWDDAWorkerPool> Pool;
+    TArray<FSWDDAWorkerPool::FJobPtr> Jobs; //En attente ou en cours, pour regrouper les requetes
+
+    FSWDDASchedulerStats Stats;
+    double LatencySum[ 2 ] = { 0, 0 }; //Par ESWDDAPriority
+    int32 NbLatencies[ 2 ] = { 0, 0 };
+};
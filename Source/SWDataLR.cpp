@@ -1,16 +1,23 @@
 ﻿#include "SWDataLR.h"
 
+#include "SWAttemptCsv.h"
 #include "SWLogisticRegression.h"
 
 #include <Misc/FileHelper.h>
 
 USWDataLR::USWDataLR()
 {
-    IndepVar = SWLogisticRegression::MatrixCreate(0, 0);
+    IndepVar.Empty();
     DepVar.Empty();
 }
 
 USWDataLR * USWDataLR::shuffle()
+{
+    FRandomStream random( FMath::Rand() );
+    return shuffle( random );
+}
+
+USWDataLR * USWDataLR::shuffle( FRandomStream & random )
 {
     auto * part = NewObject< USWDataLR >();
 
@@ -18,140 +25,133 @@ USWDataLR * USWDataLR::shuffle()
         return part;
 
     const auto nbRows = DepVar.Num();
-    const auto nbVars = IndepVar[ 0 ].Num();
+    const auto nbVars = IndepVar.Cols;
 
-    part->IndepVar.Reset( nbRows );
-    for (auto index = 0; index < nbRows; ++index)
+    TArray< int32 > order;
+    shuffleOrder( order, random );
+
+    part->IndepVar.SetSizeUninitialized( nbRows, nbVars );
+    part->DepVar.Reset( nbRows );
+    for ( auto row = 0; row < nbRows; ++row )
     {
-        part->IndepVar.Add(TArray<float>());
+        FMemory::Memcpy( part->IndepVar.Row( row ), IndepVar.Row( order[ row ] ), nbVars * sizeof( float ) );
+        part->DepVar.Add( DepVar[ order[ row ] ] );
     }
-    part->DepVar = SWLogisticRegression::VectorCreate( nbRows );
 
-    auto row = 0;
-    for ( auto & vars : IndepVar )
-    {
-        //On tire une ligne a remplir au hasard
-        const auto rowRand = FMath::RandRange(0, TNumericLimits<int>::Max()) % nbRows;
-        //sens dans lequel on cherche une case vide
-        const auto sens = FMath::RandRange(0.f, 1.f) > 0.5 ? -1 : 1;
-
-        //On cherche une case vide
-        auto nextRow = -1;
-        if ( sens > 0 )
-        {
-            for ( auto index = 0; index < nbRows; ++index )
-            {
-                const auto rowTest = ( rowRand + index ) % nbRows;
-                if ( part->IndepVar[ rowTest ].Num() == 0 )
-                    nextRow = rowTest;
-            }
-        }
-        else
-        {
-            for ( auto index = 0; index < nbRows; ++index )
-            {
-                auto rowTest = ( rowRand - index );
-                if ( rowTest < 0 )
-                    rowTest += nbRows;
-                if ( part->IndepVar[ rowTest ].Num() == 0 )
-                    nextRow = rowTest;
-            }
-        }
+    return part;
+}
 
-        if (nextRow < 0)
-            throw new std::exception("Pas trouvé de case vide, algo de shuffle marche pas");
+void USWDataLR::shuffleOrder( TArray< int32 > & order, FRandomStream & random ) const
+{
+    const auto nbRows = DepVar.Num();
 
-        part->IndepVar[nextRow].Reset(nbVars);
-                
-        for (auto index = 0; index < vars.Num(); ++index)
-        {
-            part->IndepVar[nextRow].Add(vars[index]);
-        }
-        part->DepVar[nextRow] = DepVar[row];
+    //Pas encore une permutation des lignes : on part de l'identite
+    if ( order.Num() != nbRows )
+    {
+        order.Reset( nbRows );
+        for ( auto row = 0; row < nbRows; ++row )
+            order.Add( row );
+    }
 
-        ++row;
+    //Fisher-Yates : chaque ligne echange sa place avec une ligne tiree parmi celles qui restent
+    for ( auto row = nbRows - 1; row > 0; --row )
+    {
+        const auto other = random.RandRange( 0, row );
+        order.Swap( row, other );
     }
-    
-    return part;
 }
 
 void USWDataLR::split( const int pcentStartExtract, const int pcentEndExtract, USWDataLR * partOut, USWDataLR * partIn )
 {
-    partOut = NewObject<USWDataLR>();
-    partIn = NewObject<USWDataLR>();
-
-    if (DepVar.Num() == 0)
+    //Les parties sont remplies dans les objets fournis par l'appelant
+    if (partOut == nullptr || partIn == nullptr)
         return;
 
+    split(pcentStartExtract, pcentEndExtract, partOut->IndepVar, partOut->DepVar, partIn->IndepVar, partIn->DepVar);
+}
+
+void USWDataLR::split( const int pcentStartExtract, const int pcentEndExtract, FSWMatrix & indepVarOut, TArray< float > & depVarOut, FSWMatrix & indepVarIn, TArray< float > & depVarIn ) const
+{
+    split( pcentStartExtract, pcentEndExtract, TArray< int32 >(), indepVarOut, depVarOut, indepVarIn, depVarIn );
+}
+
+void USWDataLR::split( const int pcentStartExtract, const int pcentEndExtract, const TArray< int32 > & order, FSWMatrix & indepVarOut, TArray< float > & depVarOut, FSWMatrix & indepVarIn, TArray< float > & depVarIn ) const
+{
     const auto nbLignes = DepVar.Num();
-    const auto nbVars = IndepVar[0].Num();
+    const auto nbVars = IndepVar.Cols;
 
     const auto iStart = (nbLignes * pcentStartExtract) / 100;
     const auto iEnd = (nbLignes * pcentEndExtract) / 100;
     const auto nbRowsIn = iEnd - iStart;
-    const auto nbRowsOut = DepVar.Num() - nbRowsIn;
+    const auto nbRowsOut = nbLignes - nbRowsIn;
 
-    partIn->IndepVar = SWLogisticRegression::MatrixCreate(nbRowsIn, nbVars);
-    partIn->DepVar.Reset(nbRowsIn);
+    //SetSizeUninitialized garde l'allocation si les buffers sont reutilises
+    indepVarIn.SetSizeUninitialized(nbRowsIn, nbVars);
+    depVarIn.Reset(nbRowsIn);
 
-    partOut->IndepVar = SWLogisticRegression::MatrixCreate(nbRowsOut, nbVars);
-    partOut->DepVar.Reset(nbRowsOut);
+    indepVarOut.SetSizeUninitialized(nbRowsOut, nbVars);
+    depVarOut.Reset(nbRowsOut);
+
+    //Sans permutation, les lignes sont prises dans l'ordre
+    const auto bOrdered = order.Num() == nbLignes;
 
-    auto row = 0;
     auto rowIn = 0;
     auto rowOut = 0;
-    for (auto & vars : IndepVar)
+    for (auto row = 0; row < nbLignes; ++row)
     {
+        const auto rowSrc = bOrdered ? order[row] : row;
+
         //out of section
         if (row < iStart || row >= iEnd)
         {
-            for (auto index = 0; index < vars.Num(); ++index)
-                partOut->IndepVar[rowOut][index] = vars[index];
-            partOut->DepVar.Add(DepVar[row]);
+            FMemory::Memcpy( indepVarOut.Row( rowOut ), IndepVar.Row( rowSrc ), nbVars * sizeof( float ) );
+            depVarOut.Add(DepVar[rowSrc]);
             ++rowOut;
         }
 
         //in section
         if (row >= iStart && row < iEnd)
         {
-            for (auto index = 0; index < vars.Num(); ++index)
-                partIn->IndepVar[rowIn][index] = vars[index];
-            partIn->DepVar.Add(DepVar[row]);
+            FMemory::Memcpy( indepVarIn.Row( rowIn ), IndepVar.Row( rowSrc ), nbVars * sizeof( float ) );
+            depVarIn.Add(DepVar[rowSrc]);
             ++rowIn;
         }
-
-        ++row;
     }
 
     //Console.WriteLine("Partion split: partIn=" + rowIn + " partOut:" + rowOut);
 }
 
+FSWDataView USWDataLR::View( const TArray< int32 > * order ) const
+{
+    const auto bOrdered = order != nullptr && order->Num() == DepVar.Num();
+    return FSWDataView( IndepVar, DepVar.GetData(), bOrdered ? order->GetData() : nullptr );
+}
+
+void USWDataLR::fold( const int pcentStartExtract, const int pcentEndExtract, const TArray< int32 > * order, FSWDataView & viewOut, FSWDataView & viewIn ) const
+{
+    const auto nbLignes = DepVar.Num();
+
+    //Memes bornes que split
+    const auto iStart = (nbLignes * pcentStartExtract) / 100;
+    const auto iEnd = (nbLignes * pcentEndExtract) / 100;
+
+    const auto all = View( order );
+    viewIn = all.Slice( iStart, iEnd - iStart );
+    viewOut = all.Without( iStart, iEnd - iStart );
+}
+
 USWDataLR * USWDataLR::getLastNRows( const int nbRows )
 {
     auto * part = NewObject<USWDataLR>();
     if(DepVar.Num() > 0)
     {
         const auto nbRowsTake = FMath::Min(nbRows, DepVar.Num());
-        const auto nbVars = IndepVar[0].Num();
         const auto iStart = DepVar.Num() - nbRowsTake;
 
-        part->IndepVar = SWLogisticRegression::MatrixCreate(nbRowsTake, nbVars);
-        part->DepVar = SWLogisticRegression::VectorCreate(nbRowsTake);
-
-        auto row = 0;
-        auto rowLoad = 0;
-        for (auto & vars : IndepVar)
-        {
-            //out of section
-            if (row >= iStart)
-            {
-                for (auto index = 0; index < vars.Num(); ++index)
-                    part->IndepVar[rowLoad][index] = vars[index];
-                part->DepVar[rowLoad] = DepVar[row];
-                ++rowLoad;
-            }
-            ++row;
-        }
+        //Les lignes sont contigues : on copie le bloc de fin d'un coup
+        part->IndepVar = SWLogisticRegression::MatrixDuplicate(IndepVar.View().RowRange(iStart, nbRowsTake));
+        part->DepVar.Reset(nbRowsTake);
+        part->DepVar.Append(DepVar.GetData() + iStart, nbRowsTake);
     }
 
     return part;
@@ -161,82 +161,129 @@ void USWDataLR::LoadDataFromList( TArray<TArray<float> >  & indepVars, TArray<fl
 {
     if(indepVars.Num() == 0)
     {
-        IndepVar = SWLogisticRegression::MatrixCreate(0, 0);
+        IndepVar.Empty();
         DepVar.Empty();
         return;
     }
 
     const auto nbRows = depVars.Num();
-    IndepVar = SWLogisticRegression::MatrixCreate(nbRows, indepVars[0].Num() + 1);
+    IndepVar.Init(nbRows, indepVars[0].Num() + 1);
     DepVar.Reset(nbRows);
 
     auto row = 0;
     for (auto & vars : indepVars)
     {
-        IndepVar[row][0] = 1;
+        auto * line = IndepVar.Row(row);
+        line[0] = 1;
         for (auto index = 0; index < vars.Num(); ++index)
-            IndepVar[row][index+1] = vars[index];
+            line[index+1] = vars[index];
         DepVar.Add(depVars[row]);
         ++row;
     }
 }
 
-void USWDataLR::LoadDataFromCsv( const FString csvFile )
+void USWDataLR::LoadDataFromAttempts( const FSWAttemptsView & attempts )
 {
-    if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*csvFile))
+    if (attempts.Num() == 0)
     {
-        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not Find File"));
+        IndepVar.Empty();
+        DepVar.Empty();
         return;
     }
 
-    TArray<FString> FileData;
-    FFileHelper::LoadFileToStringArray( FileData, *csvFile );
-    
-    //On compte le nombre de lignes et de variables
-    TArray<FString> tokens;
+    const auto nbRows = attempts.Num();
+    const auto nbThetas = attempts.NumThetas;
+    IndepVar.SetSizeUninitialized(nbRows, nbThetas + 1);
+    DepVar.Reset(nbRows);
+    DepVar.Append(attempts.Results.GetData(), nbRows);
 
-    //Si lgne 1, on test si headers
-    auto line = FileData[0].TrimStartAndEnd();
-    line.ParseIntoArray( tokens, TEXT(";"), false);
-    const auto nbVars = tokens.Num() - 1; //On compte aussi la variable dépendante
+    for (auto row = 0; row < nbRows; ++row)
+    {
+        auto * line = IndepVar.Row(row);
+        line[0] = 1;
+        FMemory::Memcpy(line + 1, attempts.GetThetas(row), nbThetas * sizeof(float));
+    }
+}
 
-    const auto bHeaders = FCString::Atof(*tokens[0]) == 0;
+void USWDataLR::LoadDataFromCsv( const FString csvFile )
+{
+    //Un seul passage sur le contenu brut : pas de FString par ligne ni par valeur
+    TArray<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray( FileData, *csvFile ))
+    {
+        GEngine->AddOnScreenDebugMessage(-1, 1000.f, FColor::Red, TEXT("Could not Find File"));
+        return;
+    }
 
-    const auto ct = FileData.Num() - (bHeaders ? 1 : 0); // Nombre de lignes (sans les headers)
+    const auto * begin = reinterpret_cast<const ANSICHAR *>(FileData.GetData());
+    const auto * end = begin + FileData.Num();
 
-    //On parse le fichier pour charger les datas
-    IndepVar = SWLogisticRegression::MatrixCreate(ct, nbVars + 1);
-    DepVar = SWLogisticRegression::VectorCreate(ct);
-    FFileHelper::LoadFileToStringArray( FileData, *csvFile );
+    //UTF-8 BOM d'un fichier edite a la main
+    if (FileData.Num() >= 3 && FileData[0] == 0xEF && FileData[1] == 0xBB && FileData[2] == 0xBF)
+        begin += 3;
 
-    for (auto row = 0; row < FileData.Num(); ++row)
+    //Le nombre de variables est celui de la ligne 1, qui peut etre les headers
+    auto nbVars = 0; //Sans la variable dépendante
+    for (const auto * c = begin; c < end && *c != '\n'; ++c)
+    {
+        if (*c == ';')
+            nbVars++;
+    }
+    const auto skipLine = [end](const ANSICHAR *& cursor)
+    {
+        while (cursor < end && *cursor++ != '\n')
+        {
+        }
+    };
+
+    //On parse le fichier directement dans IndepVar et DepVar, qui grandissent au fil des lignes :
+    //les TArray reservent une marge proportionnelle a leur taille, la memoire en trop est rendue a la fin
+    const auto nbCols = nbVars + 1;
+    IndepVar.Empty();
+    DepVar.Reset();
+    for (const auto * c = begin; c < end; )
     {
-        line = FileData[row].TrimStartAndEnd();
-        line.ParseIntoArray( tokens, TEXT(";"), false);
-        IndepVar[row][0] = 1.f;
-        for (auto index = 0; index < nbVars; ++index)
+        //Les headers et les lignes vides ne commencent pas par un nombre
+        if (!FSWAttemptCsv::IsDataLine(c, end))
         {
-            IndepVar[row][index + 1] = FCString::Atof( *tokens[index] );
+            skipLine(c);
+            continue;
         }
-        DepVar[row] = FCString::Atof(*tokens[tokens.Num() - 1]);
+
+        //Les valeurs au-dela des variables ne sont pas gardees, sauf la derniere qui est la variable dependante
+        IndepVar.Data.AddUninitialized(nbCols);
+        auto * vars = IndepVar.Data.GetData() + IndepVar.Data.Num() - nbCols;
+        auto result = 0.f;
+        const auto nbValues = FSWAttemptCsv::ParseLine(c, end, vars + 1, nbVars, &result);
+
+        vars[0] = 1.f;
+        for (auto index = FMath::Max(nbValues - 1, 0); index < nbVars; ++index)
+        {
+            vars[index + 1] = 0.f;
+        }
+        DepVar.Add(result);
     }
+
+    IndepVar.Rows = DepVar.Num();
+    IndepVar.Cols = nbCols;
+    IndepVar.Data.Shrink();
+    DepVar.Shrink();
 }
 
 void USWDataLR::saveDataToCsv( const FString csvFile )
 {
     FString content;
 
-    auto row = 0;
-    for (auto & vars : IndepVar)
+    for (auto row = 0; row < IndepVar.Rows; ++row)
     {
-        for (auto index = 1; index < vars.Num(); ++index)
+        const auto * vars = IndepVar.Row(row);
+        for (auto index = 1; index < IndepVar.Cols; ++index)
         {
             content.Append( FString::SanitizeFloat( vars[index] ) );
             content.Append( ";" );
         }
         content.Append( FString::SanitizeFloat( DepVar[row] ) );
         content.Append("\n");
-        ++row;
     }
 
     FFileHelper::SaveStringToFile( content, *csvFile );
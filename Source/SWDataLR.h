@@ -2,6 +2,10 @@
 
 #include <CoreMinimal.h>
 
+#include "SWAttemptStore.h"
+#include "SWDataView.h"
+#include "SWMatrix.h"
+
 #include "SWDataLR.generated.h"
 
 UCLASS()
@@ -13,17 +17,37 @@ public:
     USWDataLR();
 
     USWDataLR * shuffle();
+    USWDataLR * shuffle( FRandomStream & random );
+
+    //Melange de Fisher-Yates d'une permutation des lignes : les donnees ne bougent pas, seuls les indices sont echanges.
+    //Si order n'a pas une case par ligne, il est d'abord rempli avec 0..n-1. Rien n'est alloue si order est reutilise
+    void shuffleOrder( TArray< int32 > & order, FRandomStream & random ) const;
 
     void split( int pcentStartExtract, int pcentEndExtract, USWDataLR * partOut, USWDataLR * partIn );
 
+    //Meme decoupage, dans des buffers fournis par l'appelant (reutilisables, pas de UObject : ok hors game thread)
+    void split( int pcentStartExtract, int pcentEndExtract, FSWMatrix & indepVarOut, TArray< float > & depVarOut, FSWMatrix & indepVarIn, TArray< float > & depVarIn ) const;
+    //Idem en parcourant les lignes dans l'ordre donne par order (voir shuffleOrder)
+    void split( int pcentStartExtract, int pcentEndExtract, const TArray< int32 > & order, FSWMatrix & indepVarOut, TArray< float > & depVarOut, FSWMatrix & indepVarIn, TArray< float > & depVarIn ) const;
+
+    //Toutes les lignes, dans l'ordre ou a travers order (une case par ligne, voir shuffleOrder). Rien n'est copie :
+    //la vue n'est valable que tant que les donnees (et order) ne changent pas
+    FSWDataView View( const TArray< int32 > * order = nullptr ) const;
+
+    //Meme decoupage que split, sous forme de vues : pas de copie ni d'allocation
+    void fold( int pcentStartExtract, int pcentEndExtract, const TArray< int32 > * order, FSWDataView & viewOut, FSWDataView & viewIn ) const;
+
     USWDataLR * getLastNRows( int nbRows );
 
     void LoadDataFromList( TArray< TArray< float > > & indepVars, TArray< float > & depVars );
 
+    //Une ligne par essai : 1.0 puis les thetas, et le resultat comme variable dependante
+    void LoadDataFromAttempts( const FSWAttemptsView & attempts );
+
     void LoadDataFromCsv( FString csvFile );
 
     void saveDataToCsv( FString csvFile );
 
-    TArray< TArray< float > > IndepVar;
+    FSWMatrix IndepVar; //Une ligne par essai : 1.0 (constante) puis les variables
     TArray< float > DepVar;
 };
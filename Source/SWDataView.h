@@ -0,0 +1,94 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "SWMatrix.h"
+
+// Read-only view on the rows of a dataset (design matrix + dependent variable), without copy.
+// Rows are read through an optional permutation (Order, see USWDataLR::shuffleOrder) and restricted to at most
+// two ranges of it : a cross-validation fold is one range (test) and the permutation minus that range (train).
+// Row i of the view is Order[ j ] (or j without permutation) where j is the i-th index of [Begin[0], End[0][ then [Begin[1], End[1][.
+struct FSWDataView
+{
+    FSWDataView() = default;
+
+    // every row of xMatrix, read in order or through order (one index per row of xMatrix).
+    // yVector (one value per row of xMatrix) can be nullptr when only the xs are needed.
+    FSWDataView( const FSWMatrixView & xMatrix, const float * yVector = nullptr, const int32 * order = nullptr )
+        : XMatrix( xMatrix ), YVector( yVector ), Order( order )
+    {
+        End[ 0 ] = xMatrix.Rows;
+    }
+
+    int Num() const
+    {
+        return ( End[ 0 ] - Begin[ 0 ] ) + ( End[ 1 ] - Begin[ 1 ] );
+    }
+
+    int Cols() const
+    {
+        return XMatrix.Cols;
+    }
+
+    bool IsEmpty() const
+    {
+        return Num() == 0 || XMatrix.Cols == 0;
+    }
+
+    // rows read in XMatrix order, without gap
+    bool IsContiguous() const
+    {
+        return Order == nullptr && Begin[ 1 ] == End[ 1 ];
+    }
+
+    // the rows of a contiguous view as a matrix view
+    FSWMatrixView ContiguousRows() const
+    {
+        return XMatrix.RowRange( Begin[ 0 ], End[ 0 ] - Begin[ 0 ] );
+    }
+
+    // index in XMatrix of the row number row of the view
+    int RowIndex( const int row ) const
+    {
+        const auto nbFirst = End[ 0 ] - Begin[ 0 ];
+        const auto index = row < nbFirst ? Begin[ 0 ] + row : Begin[ 1 ] + row - nbFirst;
+        return Order != nullptr ? Order[ index ] : index;
+    }
+
+    const float * Row( const int row ) const
+    {
+        return XMatrix.Row( RowIndex( row ) );
+    }
+
+    float GetY( const int row ) const
+    {
+        return YVector[ RowIndex( row ) ];
+    }
+
+    // rows [first, first + nbRows[ of a single range view (such as the one built by the constructor)
+    FSWDataView Slice( const int first, const int nbRows ) const
+    {
+        auto slice = *this;
+        slice.Begin[ 0 ] = Begin[ 0 ] + first;
+        slice.End[ 0 ] = slice.Begin[ 0 ] + nbRows;
+        slice.Begin[ 1 ] = 0;
+        slice.End[ 1 ] = 0;
+        return slice;
+    }
+
+    // all the rows of a single range view but [first, first + nbRows[
+    FSWDataView Without( const int first, const int nbRows ) const
+    {
+        auto rest = *this;
+        rest.End[ 0 ] = Begin[ 0 ] + first;
+        rest.Begin[ 1 ] = rest.End[ 0 ] + nbRows;
+        rest.End[ 1 ] = End[ 0 ];
+        return rest;
+    }
+
+    FSWMatrixView XMatrix;
+    const float * YVector = nullptr;
+    const int32 * Order = nullptr;
+    int Begin[ 2 ] = { 0, 0 };
+    int End[ 2 ] = { 0, 0 };
+};
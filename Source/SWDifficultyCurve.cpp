@@ -0,0 +1,123 @@
+#include "SWDifficultyCurve.h"
+
+#include "SWModelLR.h"
+
+#include <HAL/PlatformProcess.h>
+
+namespace
+{
+    float Interpolate( const float * samples, const float x )
+    {
+        const auto position = FMath::Clamp( x, 0.f, 1.f ) * FSWDifficultyCurve::NbIntervals;
+        const auto index = FMath::Min( static_cast< int32 >( position ), FSWDifficultyCurve::NbIntervals - 1 );
+        const auto alpha = position - index;
+        return samples[ index ] + ( samples[ index + 1 ] - samples[ index ] ) * alpha;
+    }
+}
+
+void FSWDifficultyCurve::Fill( USWModelLR * model, const bool bReadyIn, const uint32 dataVersionIn )
+{
+    bReady = bReadyIn && model != nullptr && model->Betas.Num() >= 2;
+    DataVersion = dataVersionIn;
+    Betas.Reset();
+    if ( !bReady )
+        return;
+
+    Betas = model->Betas;
+
+    //Les tables sont calculees avec Predict et InvPredict eux-memes : aux echantillons, memes valeurs que computeNewDiffParams
+    TArray< float > values;
+    values.AddZeroed( Betas.Num() - 1 );
+    for ( auto index = 0; index <= NbIntervals; ++index )
+    {
+        const auto x = static_cast< float >( index ) / NbIntervals;
+
+        values[ 0 ] = x;
+        DifficultyByTheta[ index ] = 1.0f - model->Predict( values );
+
+        //Difficulte 0 ou 1 : theta infini, on garde la borne
+        const auto theta = model->InvPredict( 1.0f - x, values, 0 );
+        ThetaByDifficulty[ index ] = FMath::IsNaN( theta ) ? 0.f : FMath::Clamp( theta, 0.f, 1.f );
+    }
+}
+
+float FSWDifficultyCurve::GetDifficulty( const float theta ) const
+{
+    return bReady ? Interpolate( DifficultyByTheta, theta ) : -1;
+}
+
+float FSWDifficultyCurve::GetTheta( const float difficulty ) const
+{
+    return bReady ? Interpolate( ThetaByDifficulty, difficulty ) : -1;
+}
+
+void FSWDifficultyCurveSnapshot::Publish( USWModelLR * model, const bool bReady, const uint32 dataVersion )
+{
+    //Un seul ecrivain : un slot libre autre que le courant (les lectures sont courtes, on attend rarement)
+    const auto current = Current.load();
+    int32 slot = INDEX_NONE;
+    while ( slot == INDEX_NONE )
+    {
+        for ( auto index = 0; index < NbSlots && slot == INDEX_NONE; ++index )
+        {
+            if ( index != current && Slots[ index ].NbReaders.load() == 0 )
+                slot = index;
+        }
+        if ( slot == INDEX_NONE )
+            FPlatformProcess::Sleep( 0 );
+    }
+
+    Slots[ slot ].Curve.Fill( model, bReady, dataVersion );
+    Current.store( slot );
+}
+
+int32 FSWDifficultyCurveSnapshot::BeginRead() const
+{
+    while ( true )
+    {
+        const auto slot = Current.load();
+        Slots[ slot ].NbReaders++;
+
+        //Toujours courant apres le marquage : Publish ne le reecrira pas avant EndRead
+        if ( Current.load() == slot )
+            return slot;
+
+        Slots[ slot ].NbReaders--;
+    }
+}
+
+void FSWDifficultyCurveSnapshot::EndRead( const int32 slot ) const
+{
+    Slots[ slot ].NbReaders--;
+}
+
+bool FSWDifficultyCurveSnapshot::IsReady() const
+{
+    const auto slot = BeginRead();
+    const auto bReady = Slots[ slot ].Curve.bReady;
+    EndRead( slot );
+    return bReady;
+}
+
+float FSWDifficultyCurveSnapshot::GetDifficulty( const float theta ) const
+{
+    const auto slot = BeginRead();
+    const auto difficulty = Slots[ slot ].Curve.GetDifficulty( theta );
+    EndRead( slot );
+    return difficulty;
+}
+
+float FSWDifficultyCurveSnapshot::GetTheta( const float difficulty ) const
+{
+    const auto slot = BeginRead();
+    const auto theta = Slots[ slot ].Curve.GetTheta( difficulty );
+    EndRead( slot );
+    return theta;
+}
+
+void FSWDifficultyCurveSnapshot::Read( FSWDifficultyCurve & curve ) const
+{
+    const auto slot = BeginRead();
+    curve = Slots[ slot ].Curve;
+    EndRead( slot );
+}
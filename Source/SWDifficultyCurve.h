@@ -0,0 +1,61 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <atomic>
+
+class USWModelLR;
+
+// Difficulty <-> theta curve of a fitted regression, sampled once when it is published so that reading it needs neither
+// log nor exp. Only the first theta varies, the other ones are set to 0 (as checkLogReg does).
+// Theta is taken in [0,1] : outside of it, the result of the closest bound is returned
+struct SWARMS_API FSWDifficultyCurve
+{
+    static constexpr int32 NbIntervals = 256;
+
+    bool bReady = false;      //LogRegReady du calcul publie : sans lui, les tables sont vides
+    uint32 DataVersion = 0;   //DataVersion du modele au moment du calcul
+    TArray< float > Betas;
+    float DifficultyByTheta[ NbIntervals + 1 ] = {};  //1 - Predict, theta = index / NbIntervals
+    float ThetaByDifficulty[ NbIntervals + 1 ] = {};  //InvPredict( 1 - difficulty ), difficulty = index / NbIntervals, borne a [0,1]
+
+    // Samples model (which must be usable if bReady)
+    void Fill( USWModelLR * model, bool bReadyIn, uint32 dataVersionIn );
+
+    // Linear interpolation between the samples
+    float GetDifficulty( float theta ) const;
+    float GetTheta( float difficulty ) const;
+};
+
+// Last curve published by a model, readable from any thread without lock : the curves are kept in 3 slots,
+// Publish fills a slot that is neither the current one nor being read, then makes it current with one atomic store.
+// A reader marks the current slot as read, then checks that it is still current before using it
+class SWARMS_API FSWDifficultyCurveSnapshot
+{
+public:
+    // Game thread only
+    void Publish( USWModelLR * model, bool bReady, uint32 dataVersion );
+
+    // Any thread. The queries return -1 while no ready curve is published
+    bool IsReady() const;
+    float GetDifficulty( float theta ) const;
+    float GetTheta( float difficulty ) const;
+    // Copy of the whole curve (betas included)
+    void Read( FSWDifficultyCurve & curve ) const;
+
+private:
+    static constexpr int32 NbSlots = 3;
+
+    struct FSlot
+    {
+        FSWDifficultyCurve Curve;
+        mutable std::atomic< int32 > NbReaders { 0 };
+    };
+
+    // Slot current when it was marked, to unmark with EndRead
+    int32 BeginRead() const;
+    void EndRead( int32 slot ) const;
+
+    FSlot Slots[ NbSlots ];
+    std::atomic< int32 > Current { 0 };
+};
@@ -0,0 +1,276 @@
+#include "SWLRKernel.h"
+
+#if !defined( SW_LRKERNEL_FORCE_SCALAR )
+    #if defined( __AVX2__ )
+        #define SW_LRKERNEL_AVX2 1
+        #include <immintrin.h>
+    #elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+        #define SW_LRKERNEL_SSE2 1
+        #include <emmintrin.h>
+    #elif defined( __aarch64__ ) || defined( _M_ARM64 )
+        #define SW_LRKERNEL_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+namespace
+{
+    // exp(x) = 2^n * exp(g) with n = round(x / ln(2)) and |g| <= ln(2) / 2, exp(g) being a polynomial (Cephes expf).
+    // The same constants and operations are used by the scalar and the vector versions
+    // so a row gets the same probability whatever lane it falls in.
+    const float ExpHi = 88.3f;  // exp(88.3) still fits in a float
+    const float ExpLo = -87.3f; // exp(-87.3) is still a normalized float
+    const float Log2e = 1.44269504088896341f;
+    const float ExpC1 = 0.693359375f;
+    const float ExpC2 = -2.12194440e-4f;
+    const float ExpP0 = 1.9875691500e-4f;
+    const float ExpP1 = 1.3981999507e-3f;
+    const float ExpP2 = 8.3334519073e-3f;
+    const float ExpP3 = 4.1665795894e-2f;
+    const float ExpP4 = 1.6666665459e-1f;
+    const float ExpP5 = 5.0000001201e-1f;
+
+    float SigmoidScalar( const float z )
+    {
+        // p = 1 / (1 + exp(-z))
+        auto x = FMath::Clamp( -z, ExpLo, ExpHi );
+        const auto fx = FMath::FloorToFloat( x * Log2e + 0.5f );
+        x = x - fx * ExpC1;
+        x = x - fx * ExpC2;
+
+        auto y = ExpP0;
+        y = y * x + ExpP1;
+        y = y * x + ExpP2;
+        y = y * x + ExpP3;
+        y = y * x + ExpP4;
+        y = y * x + ExpP5;
+        y = y * x * x + x + 1.0f;
+
+        const auto bits = ( static_cast< int32 >( fx ) + 127 ) << 23; // 2^n
+        float pow2n;
+        FMemory::Memcpy( &pow2n, &bits, sizeof( float ) );
+
+        return 1.0f / ( 1.0f + y * pow2n );
+    }
+
+    float Dot( const float * xRow, const float * bVector, const int nbCols )
+    {
+        auto z = 0.f;
+        for ( auto j = 0; j < nbCols; ++j )
+            z += xRow[ j ] * bVector[ j ]; // b0(1.0) + b1x1 + b2x2 + . . .
+        return z;
+    }
+
+    // rows [firstRow, nbRows[ one at a time. used for the whole data when no vector unit is available, and for the tail otherwise.
+    void EvaluateScalar( const int firstRow, const FSWDataView & data, const float * bVector, float * outProb, float * outWeight, float * outResidual, float & squaredError, int & nbCorrect )
+    {
+        const auto nbRows = data.Num();
+        const auto nbCols = data.Cols();
+        for ( auto i = firstRow; i < nbRows; ++i )
+        {
+            const auto rowIndex = data.RowIndex( i );
+            const auto p = SigmoidScalar( Dot( data.XMatrix.Row( rowIndex ), bVector, nbCols ) );
+
+            if ( outProb != nullptr )
+                outProb[ i ] = p;
+            if ( outWeight != nullptr )
+                outWeight[ i ] = p * ( 1.0f - p );
+
+            if ( data.YVector != nullptr )
+            {
+                const auto y = data.YVector[ rowIndex ];
+                const auto r = y - p;
+                if ( outResidual != nullptr )
+                    outResidual[ i ] = r;
+                squaredError += r * r;
+                if ( ( p >= 0.5f && y == 1.0f ) || ( p < 0.5f && y == 0.0f ) )
+                    ++nbCorrect;
+            }
+        }
+    }
+
+#if SW_LRKERNEL_AVX2
+    struct FSWVec
+    {
+        typedef __m256 Type;
+        static const int Width = 8;
+
+        static Type Load( const float * p ) { return _mm256_loadu_ps( p ); }
+        static void Store( float * p, const Type v ) { _mm256_storeu_ps( p, v ); }
+        static Type Set( const float v ) { return _mm256_set1_ps( v ); }
+        static Type Add( const Type a, const Type b ) { return _mm256_add_ps( a, b ); }
+        static Type Sub( const Type a, const Type b ) { return _mm256_sub_ps( a, b ); }
+        static Type Mul( const Type a, const Type b ) { return _mm256_mul_ps( a, b ); }
+        static Type Div( const Type a, const Type b ) { return _mm256_div_ps( a, b ); }
+        static Type Min( const Type a, const Type b ) { return _mm256_min_ps( a, b ); }
+        static Type Max( const Type a, const Type b ) { return _mm256_max_ps( a, b ); }
+        static Type Floor( const Type a ) { return _mm256_floor_ps( a ); }
+        static Type Pow2( const Type n ) { return _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_add_epi32( _mm256_cvttps_epi32( n ), _mm256_set1_epi32( 127 ) ), 23 ) ); }
+        // masks are all-ones / all-zeros lanes
+        static Type GreaterEqual( const Type a, const Type b ) { return _mm256_cmp_ps( a, b, _CMP_GE_OQ ); }
+        static Type Less( const Type a, const Type b ) { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+        static Type Equal( const Type a, const Type b ) { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+        static Type And( const Type a, const Type b ) { return _mm256_and_ps( a, b ); }
+        static Type Or( const Type a, const Type b ) { return _mm256_or_ps( a, b ); }
+    };
+#elif SW_LRKERNEL_SSE2
+    struct FSWVec
+    {
+        typedef __m128 Type;
+        static const int Width = 4;
+
+        static Type Load( const float * p ) { return _mm_loadu_ps( p ); }
+        static void Store( float * p, const Type v ) { _mm_storeu_ps( p, v ); }
+        static Type Set( const float v ) { return _mm_set1_ps( v ); }
+        static Type Add( const Type a, const Type b ) { return _mm_add_ps( a, b ); }
+        static Type Sub( const Type a, const Type b ) { return _mm_sub_ps( a, b ); }
+        static Type Mul( const Type a, const Type b ) { return _mm_mul_ps( a, b ); }
+        static Type Div( const Type a, const Type b ) { return _mm_div_ps( a, b ); }
+        static Type Min( const Type a, const Type b ) { return _mm_min_ps( a, b ); }
+        static Type Max( const Type a, const Type b ) { return _mm_max_ps( a, b ); }
+        static Type Floor( const Type a )
+        {
+            // no _mm_floor_ps before SSE4.1 : truncate, then step down where truncation went up (negative values)
+            const auto t = _mm_cvtepi32_ps( _mm_cvttps_epi32( a ) );
+            return _mm_sub_ps( t, _mm_and_ps( _mm_cmpgt_ps( t, a ), _mm_set1_ps( 1.0f ) ) );
+        }
+        static Type Pow2( const Type n ) { return _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( _mm_cvttps_epi32( n ), _mm_set1_epi32( 127 ) ), 23 ) ); }
+        static Type GreaterEqual( const Type a, const Type b ) { return _mm_cmpge_ps( a, b ); }
+        static Type Less( const Type a, const Type b ) { return _mm_cmplt_ps( a, b ); }
+        static Type Equal( const Type a, const Type b ) { return _mm_cmpeq_ps( a, b ); }
+        static Type And( const Type a, const Type b ) { return _mm_and_ps( a, b ); }
+        static Type Or( const Type a, const Type b ) { return _mm_or_ps( a, b ); }
+    };
+#elif SW_LRKERNEL_NEON
+    struct FSWVec
+    {
+        typedef float32x4_t Type;
+        static const int Width = 4;
+
+        static Type Load( const float * p ) { return vld1q_f32( p ); }
+        static void Store( float * p, const Type v ) { vst1q_f32( p, v ); }
+        static Type Set( const float v ) { return vdupq_n_f32( v ); }
+        static Type Add( const Type a, const Type b ) { return vaddq_f32( a, b ); }
+        static Type Sub( const Type a, const Type b ) { return vsubq_f32( a, b ); }
+        static Type Mul( const Type a, const Type b ) { return vmulq_f32( a, b ); }
+        static Type Div( const Type a, const Type b ) { return vdivq_f32( a, b ); }
+        static Type Min( const Type a, const Type b ) { return vminq_f32( a, b ); }
+        static Type Max( const Type a, const Type b ) { return vmaxq_f32( a, b ); }
+        static Type Floor( const Type a ) { return vrndmq_f32( a ); }
+        static Type Pow2( const Type n ) { return vreinterpretq_f32_s32( vshlq_n_s32( vaddq_s32( vcvtq_s32_f32( n ), vdupq_n_s32( 127 ) ), 23 ) ); }
+        static Type GreaterEqual( const Type a, const Type b ) { return vreinterpretq_f32_u32( vcgeq_f32( a, b ) ); }
+        static Type Less( const Type a, const Type b ) { return vreinterpretq_f32_u32( vcltq_f32( a, b ) ); }
+        static Type Equal( const Type a, const Type b ) { return vreinterpretq_f32_u32( vceqq_f32( a, b ) ); }
+        static Type And( const Type a, const Type b ) { return vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) ); }
+        static Type Or( const Type a, const Type b ) { return vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) ); }
+    };
+#endif
+
+#if SW_LRKERNEL_AVX2 || SW_LRKERNEL_SSE2 || SW_LRKERNEL_NEON
+    FSWVec::Type SigmoidVector( const FSWVec::Type z )
+    {
+        // same steps as SigmoidScalar, Width lanes at a time
+        auto x = FSWVec::Sub( FSWVec::Set( 0.f ), z );
+        x = FSWVec::Min( FSWVec::Max( x, FSWVec::Set( ExpLo ) ), FSWVec::Set( ExpHi ) );
+        const auto fx = FSWVec::Floor( FSWVec::Add( FSWVec::Mul( x, FSWVec::Set( Log2e ) ), FSWVec::Set( 0.5f ) ) );
+        x = FSWVec::Sub( x, FSWVec::Mul( fx, FSWVec::Set( ExpC1 ) ) );
+        x = FSWVec::Sub( x, FSWVec::Mul( fx, FSWVec::Set( ExpC2 ) ) );
+
+        auto y = FSWVec::Set( ExpP0 );
+        y = FSWVec::Add( FSWVec::Mul( y, x ), FSWVec::Set( ExpP1 ) );
+        y = FSWVec::Add( FSWVec::Mul( y, x ), FSWVec::Set( ExpP2 ) );
+        y = FSWVec::Add( FSWVec::Mul( y, x ), FSWVec::Set( ExpP3 ) );
+        y = FSWVec::Add( FSWVec::Mul( y, x ), FSWVec::Set( ExpP4 ) );
+        y = FSWVec::Add( FSWVec::Mul( y, x ), FSWVec::Set( ExpP5 ) );
+        y = FSWVec::Add( FSWVec::Add( FSWVec::Mul( FSWVec::Mul( y, x ), x ), x ), FSWVec::Set( 1.0f ) );
+
+        const auto one = FSWVec::Set( 1.0f );
+        return FSWVec::Div( one, FSWVec::Add( one, FSWVec::Mul( y, FSWVec::Pow2( fx ) ) ) );
+    }
+
+    // processes the rows by blocks of FSWVec::Width and returns the number of rows done (the rest goes to EvaluateScalar)
+    int EvaluateVector( const FSWDataView & data, const float * bVector, float * outProb, float * outWeight, float * outResidual, float & squaredError, int & nbCorrect )
+    {
+        const auto width = FSWVec::Width;
+        const auto nbBlocks = data.Num() / width;
+        const auto nbCols = data.Cols();
+
+        const auto one = FSWVec::Set( 1.0f );
+        const auto zero = FSWVec::Set( 0.0f );
+        const auto half = FSWVec::Set( 0.5f );
+        auto squaredErrorLanes = zero;
+        auto correctLanes = zero;
+
+        float z[ width ];
+        float yLanes[ width ];
+        for ( auto block = 0; block < nbBlocks; ++block )
+        {
+            const auto i = block * width;
+
+            // linear predictor : the rows are short (intercept + a few thetas), a scalar dot per row is enough.
+            // rows (and ys) are gathered through the view : folds and permutations are read in place
+            for ( auto lane = 0; lane < width; ++lane )
+            {
+                const auto rowIndex = data.RowIndex( i + lane );
+                z[ lane ] = Dot( data.XMatrix.Row( rowIndex ), bVector, nbCols );
+                if ( data.YVector != nullptr )
+                    yLanes[ lane ] = data.YVector[ rowIndex ];
+            }
+
+            const auto p = SigmoidVector( FSWVec::Load( z ) );
+
+            if ( outProb != nullptr )
+                FSWVec::Store( outProb + i, p );
+            if ( outWeight != nullptr )
+                FSWVec::Store( outWeight + i, FSWVec::Mul( p, FSWVec::Sub( one, p ) ) );
+
+            if ( data.YVector != nullptr )
+            {
+                const auto y = FSWVec::Load( yLanes );
+                const auto r = FSWVec::Sub( y, p );
+                if ( outResidual != nullptr )
+                    FSWVec::Store( outResidual + i, r );
+                squaredErrorLanes = FSWVec::Add( squaredErrorLanes, FSWVec::Mul( r, r ) );
+
+                const auto correct = FSWVec::Or(
+                    FSWVec::And( FSWVec::GreaterEqual( p, half ), FSWVec::Equal( y, one ) ),
+                    FSWVec::And( FSWVec::Less( p, half ), FSWVec::Equal( y, zero ) ) );
+                correctLanes = FSWVec::Add( correctLanes, FSWVec::And( correct, one ) );
+            }
+        }
+
+        // lanes are summed in a fixed order so the result does not depend on anything but the data
+        float lanes[ width ];
+        FSWVec::Store( lanes, squaredErrorLanes );
+        for ( auto lane = 0; lane < width; ++lane )
+            squaredError += lanes[ lane ];
+        FSWVec::Store( lanes, correctLanes );
+        for ( auto lane = 0; lane < width; ++lane )
+            nbCorrect += static_cast< int >( lanes[ lane ] );
+
+        return nbBlocks * width;
+    }
+#endif
+}
+
+void SWLRKernel::Evaluate( const FSWMatrixView & xMatrix, const float * yVector, const float * bVector, float * outProb, float * outWeight, float * outResidual, FSWLRKernelStats & stats )
+{
+    Evaluate( FSWDataView( xMatrix, yVector ), bVector, outProb, outWeight, outResidual, stats );
+}
+
+void SWLRKernel::Evaluate( const FSWDataView & data, const float * bVector, float * outProb, float * outWeight, float * outResidual, FSWLRKernelStats & stats )
+{
+    stats = FSWLRKernelStats();
+    stats.NbRows = data.Num();
+
+    if ( data.Num() == 0 )
+        return;
+
+    auto firstScalarRow = 0;
+
+#if SW_LRKERNEL_AVX2 || SW_LRKERNEL_SSE2 || SW_LRKERNEL_NEON
+    firstScalarRow = EvaluateVector( data, bVector, outProb, outWeight, outResidual, stats.SquaredError, stats.NbCorrect );
+#endif
+
+    EvaluateScalar( firstScalarRow, data, bVector, outProb, outWeight, outResidual, stats.SquaredError, stats.NbCorrect );
+}
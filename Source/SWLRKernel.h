@@ -0,0 +1,39 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "SWDataView.h"
+#include "SWMatrix.h"
+
+//Resultats agreges d'une passe du noyau logistique
+struct FSWLRKernelStats
+{
+    float SquaredError = 0; //Somme des (p - y)^2
+    int NbCorrect = 0;      //Nombre de lignes bien predites : (p >= 0.5) == (y == 1)
+    int NbRows = 0;
+
+    float MeanSquaredError() const
+    {
+        return NbRows > 0 ? SquaredError / NbRows : 0.f;
+    }
+
+    //Entre 0 et 1
+    float Accuracy() const
+    {
+        return NbRows > 0 ? static_cast< float >( NbCorrect ) / NbRows : 0.f;
+    }
+};
+
+class SWARMS_API SWLRKernel
+{
+public:
+    // Single pass over the rows of xMatrix computing, for each row i :
+    //  z = x[i].b, p = 1 / (1 + exp(-z)), w = p(1-p), r = y - p
+    // and accumulating the squared error and the number of correct predictions in stats.
+    // The sigmoid is vectorized (AVX2, SSE2 or NEON depending on the target, scalar otherwise).
+    // outProb, outWeight and outResidual receive p, w and r (one value per row) and can be nullptr when not needed.
+    // yVector can be nullptr if only p and w are wanted : stats then only hold NbRows.
+    static void Evaluate( const FSWMatrixView & xMatrix, const float * yVector, const float * bVector, float * outProb, float * outWeight, float * outResidual, FSWLRKernelStats & stats );
+    // Same pass over the rows of a view (fold, permutation) : outputs are indexed by the row number in the view.
+    static void Evaluate( const FSWDataView & data, const float * bVector, float * outProb, float * outWeight, float * outResidual, FSWLRKernelStats & stats );
+};
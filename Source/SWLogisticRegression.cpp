@@ -1,28 +1,101 @@
 #include "SWLogisticRegression.h"
 
 #include "SWDataLR.h"
+#include "SWLRKernel.h"
 #include "SWModelLR.h"
 
-USWModelLR * SWLogisticRegression::ComputeModel( USWDataLR * datas )
+USWModelLR * SWLogisticRegression::ComputeModel( USWDataLR * datas, const ESWNewtonSolver solver, const TArray< float > & initialBetas )
+{
+    // most challenges have 1 to 3 thetas : fixed size version (first column is the constant)
+    if ( solver == ESWNewtonSolver::CHOLESKY )
+    {
+        switch ( datas->IndepVar.Cols )
+        {
+            case 2:
+                return ComputeModel< 1 >( datas, initialBetas );
+            case 3:
+                return ComputeModel< 2 >( datas, initialBetas );
+            case 4:
+                return ComputeModel< 3 >( datas, initialBetas );
+            default:
+                break;
+        }
+    }
+
+    auto model = NewObject< USWModelLR >();
+
+    try
+    {
+        model->Betas = ComputeBetas( datas->IndepVar, datas->DepVar, model->FailedPivot, solver, initialBetas ); // computing the beta parameters is synonymous with 'training'
+    }
+    catch ( std::exception * e )
+    {
+        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in ComputeBestBeta: %hs" ), e->what() ) );
+        delete e;
+    }
+
+    return model;
+}
+
+TArray< float > SWLogisticRegression::ComputeBetas( const FSWMatrixView & xMatrix, TArray< float > & yVector, int & failedPivot, const ESWNewtonSolver solver, const TArray< float > & initialBetas )
+{
+    if ( xMatrix.Rows != yVector.Num() )
+        throw new std::exception( "The xMatrix and yVector are not compatible in ComputeBetas()" );
+
+    return ComputeBetas( FSWDataView( xMatrix, yVector.GetData() ), failedPivot, solver, initialBetas );
+}
+
+TArray< float > SWLogisticRegression::ComputeBetas( const FSWDataView & data, int & failedPivot, const ESWNewtonSolver solver, const TArray< float > & initialBetas )
+{
+    const auto maxIterations = 25;
+    const auto epsilon = 0.01f;      // stop if all new beta values change less than epsilon (algorithm has converged?)
+    const auto jumpFactor = 1000.0f; // stop if any new beta jumps too much (algorithm spinning out of control?)
+
+    // most challenges have 1 to 3 thetas : use the fixed size solvers (first column is the constant)
+    if ( solver == ESWNewtonSolver::CHOLESKY )
+    {
+        switch ( data.Cols() )
+        {
+            case 2:
+                return ComputeBestBetaFixed< 1 >( data, maxIterations, epsilon, jumpFactor, &failedPivot, initialBetas );
+            case 3:
+                return ComputeBestBetaFixed< 2 >( data, maxIterations, epsilon, jumpFactor, &failedPivot, initialBetas );
+            case 4:
+                return ComputeBestBetaFixed< 3 >( data, maxIterations, epsilon, jumpFactor, &failedPivot, initialBetas );
+            default:
+                break;
+        }
+    }
+
+    return ComputeBestBeta( data, maxIterations, epsilon, jumpFactor, solver, &failedPivot, initialBetas );
+}
+
+template< int NumVars >
+USWModelLR * SWLogisticRegression::ComputeModel( USWDataLR * datas, const TArray< float > & initialBetas )
 {
     auto model = NewObject< USWModelLR >();
 
     try
     {
         const auto maxIterations = 25;
-        const auto epsilon = 0.01f;      // stop if all new beta values change less than epsilon (algorithm has converged?)
-        const auto jumpFactor = 1000.0f; // stop if any new beta jumps too much (algorithm spinning out of control?)
+        const auto epsilon = 0.01f;      // same settings as the generic ComputeModel
+        const auto jumpFactor = 1000.0f;
 
-        model->Betas = ComputeBestBeta( datas->IndepVar, datas->DepVar, maxIterations, epsilon, jumpFactor ); // computing the beta parameters is synonymous with 'training'
+        model->Betas = ComputeBestBetaFixed< NumVars >( datas->IndepVar, datas->DepVar, maxIterations, epsilon, jumpFactor, &model->FailedPivot, initialBetas );
     }
-    catch ( std::exception e )
+    catch ( std::exception * e )
     {
-        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in ComputeBestBeta: %hs" ), e.what() ) );
+        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in ComputeBestBetaFixed: %hs" ), e->what() ) );
+        delete e;
     }
 
     return model;
 }
 
+template USWModelLR * SWLogisticRegression::ComputeModel< 1 >( USWDataLR * datas, const TArray< float > & initialBetas );
+template USWModelLR * SWLogisticRegression::ComputeModel< 2 >( USWDataLR * datas, const TArray< float > & initialBetas );
+template USWModelLR * SWLogisticRegression::ComputeModel< 3 >( USWDataLR * datas, const TArray< float > & initialBetas );
+
 float SWLogisticRegression::TestModel( USWModelLR * model, USWDataLR * testData )
 {
     float acc = 0;
@@ -30,15 +103,32 @@ float SWLogisticRegression::TestModel( USWModelLR * model, USWDataLR * testData
     {
         acc = PredictiveAccuracy( testData->IndepVar, testData->DepVar, model->Betas ) / 100.0; // percent of data cases correctly predicted in the test data set.
     }
-    catch ( std::exception e )
+    catch ( std::exception * e )
     {
-        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in TestModel: %hs" ), e.what() ) );
+        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in TestModel: %hs" ), e->what() ) );
+        delete e;
     }
 
     return acc;
 }
 
-float SWLogisticRegression::PredictiveAccuracy( TArray< TArray< float > > & xMatrix, TArray< float > & yVector, TArray< float > & bVector )
+float SWLogisticRegression::TestModel( USWModelLR * model, const FSWDataView & testData )
+{
+    float acc = 0;
+    try
+    {
+        acc = PredictiveAccuracy( testData, model->Betas ) / 100.0;
+    }
+    catch ( std::exception * e )
+    {
+        GEngine->AddOnScreenDebugMessage( -1, 1000.f, FColor::Red, FString::Printf( TEXT( "Fatal in TestModel: %hs" ), e->what() ) );
+        delete e;
+    }
+
+    return acc;
+}
+
+float SWLogisticRegression::PredictiveAccuracy( const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & bVector )
 {
     // returns the percent (as 0.00 to 100.00) accuracy of the bVector measured by how many lines of data are correctly predicted.
     // note: this is not the same as accuracy as measured by sum of squared deviations between
@@ -48,40 +138,46 @@ float SWLogisticRegression::PredictiveAccuracy( TArray< TArray< float > > & xMat
     if ( xMatrix.Num() == 0 || yVector.Num() == 0 || bVector.Num() == 0 )
         return 0;
 
-    const auto xRows = xMatrix.Num();
-    const auto xCols = xMatrix[ 0 ].Num();
+    const auto xRows = xMatrix.Rows;
+    const auto xCols = xMatrix.Cols;
     const auto yRows = yVector.Num();
     const auto bRows = bVector.Num();
     if ( xCols != bRows || xRows != yRows )
         throw new std::exception( "Bad dimensions for xMatrix or yVector or bVector in PredictiveAccuracy()" );
 
-    auto numberCasesCorrect = 0;
-    auto numberCasesWrong = 0;
-    auto pVector = ConstructProbVector( xMatrix, bVector ); // helper also used by LogisticRegressionNewtonParameters()
-    const auto pRows = pVector.Num();
-    if ( pRows != xRows )
-        throw new std::exception( "Unequal rows in prob vector and design matrix in PredictiveAccuracy()" );
+    return PredictiveAccuracy( FSWDataView( xMatrix, yVector.GetData() ), bVector );
+}
 
-    for ( auto i = 0; i < yRows; ++i ) // each dependent variable
-    {
-        if ( pVector[ i ] >= 0.50 && yVector[ i ] == 1.0 )
-            ++numberCasesCorrect;
-        else if ( pVector[ i ] < 0.50 && yVector[ i ] == 0.0 )
-            ++numberCasesCorrect;
-        else
-            ++numberCasesWrong;
-    }
+float SWLogisticRegression::PredictiveAccuracy( const FSWDataView & data, const TArray< float > & bVector )
+{
+    if ( data.Num() == 0 || bVector.Num() == 0 )
+        return 0;
+
+    if ( data.Cols() != bVector.Num() || data.YVector == nullptr )
+        throw new std::exception( "Bad dimensions for data or bVector in PredictiveAccuracy()" );
+
+    // probabilities and correct cases in one pass, nothing is stored
+    FSWLRKernelStats stats;
+    SWLRKernel::Evaluate( data, bVector.GetData(), nullptr, nullptr, nullptr, stats );
 
-    const auto total = numberCasesCorrect + numberCasesWrong;
+    const auto total = stats.NbRows;
     if ( total == 0 )
         return 0.0;
     else
-        return ( 100.0 * numberCasesCorrect ) / total;
+        return ( 100.0 * stats.NbCorrect ) / total;
 }
 
 // ============================================================================================
 
-TArray< float > SWLogisticRegression::ComputeBestBeta( TArray< TArray< float > > & xMatrix, TArray< float > & yVector, const int maxIterations, const float epsilon, const float jumpFactor )
+TArray< float > SWLogisticRegression::ComputeBestBeta( const FSWMatrixView & xMatrix, TArray< float > & yVector, const int maxIterations, const float epsilon, const float jumpFactor, const ESWNewtonSolver solver, int * failedPivot, const TArray< float > & initialBetas )
+{
+    if ( xMatrix.Rows != yVector.Num() )
+        throw new std::exception( "The xMatrix and yVector are not compatible in LogisticRegressionNewtonParameters()" );
+
+    return ComputeBestBeta( FSWDataView( xMatrix, yVector.GetData() ), maxIterations, epsilon, jumpFactor, solver, failedPivot, initialBetas );
+}
+
+TArray< float > SWLogisticRegression::ComputeBestBeta( const FSWDataView & data, const int maxIterations, const float epsilon, const float jumpFactor, const ESWNewtonSolver solver, int * failedPivot, const TArray< float > & initialBetas )
 {
     // Use the Newton-Raphson technique to estimate logistic regression beta parameters
     // xMatrix is a design matrix of predictor variables where the first column is augmented with all 1.0 to represent dummy x values for the b0 constant
@@ -94,38 +190,62 @@ TArray< float > SWLogisticRegression::ComputeBestBeta( TArray< TArray< float > >
     // There is a lot that can go wrong here. The algorithm involves finding a matrx inverse (see MatrixInverse) which will throw
     // if the inverse cannot be computed. The Newton-Raphson algorithm can generate beta values that tend towards infinity.
     // If anything bad happens the return is the best beta values known at the time (which could be all 0.0 values but not null).
+    // solver selects how each Newton step is computed (see ESWNewtonSolver).
+    // failedPivot, if given, receives the index of the X'WX pivot that made the algorithm stop (-1 if none, 0 if the LU inverse failed).
+    // initialBetas, if it has one value per column of xMatrix, is used as the starting point instead of all 0.0.
+    // betas fitted on nearly the same data (previous fit, overlapping folds) usually converge in one or two iterations.
+    // data can be any view (fold, permutation) with the CHOLESKY solver. LU_INVERSE builds X' explicitly and needs contiguous rows.
+
+    if ( failedPivot != nullptr )
+        *failedPivot = -1;
 
-    if ( xMatrix.Num() == 0 )
+    if ( data.Num() == 0 )
         return TArray< float >();
 
-    const auto xRows = xMatrix.Num();
-    const auto xCols = xMatrix[ 0 ].Num();
+    const auto xRows = data.Num();
+    const auto xCols = data.Cols();
 
-    if ( xRows != yVector.Num() )
-        throw new std::exception( "The xMatrix and yVector are not compatible in LogisticRegressionNewtonParameters()" );
+    if ( data.YVector == nullptr )
+        throw new std::exception( "No yVector in LogisticRegressionNewtonParameters()" );
+
+    // the historic LU path works on whole matrices
+    FSWMatrixView xMatrix;
+    TArray< float > yVector;
+    if ( solver == ESWNewtonSolver::LU_INVERSE )
+    {
+        if ( !data.IsContiguous() )
+            throw new std::exception( "The LU_INVERSE solver needs contiguous rows in LogisticRegressionNewtonParameters()" );
+        xMatrix = data.ContiguousRows();
+        yVector.Append( data.YVector + data.Begin[ 0 ], xRows );
+    }
 
     // initial beta values
     TArray< float > bVector;
     bVector.Reserve( xCols );
-    for ( auto i = 0; i < xCols; ++i )
+    if ( IsValidStart( initialBetas, xCols ) )
+        bVector.Append( initialBetas ); // warm start
+    for ( auto i = bVector.Num(); i < xCols; ++i )
     {
         bVector.Add(0.0);
-    } // initialize to 0.0. TODO: consider alternatives
+    } // otherwise initialize to 0.0
       //Console.WriteLine("The initial B vector is");
       //Console.WriteLine(VectorAsString(bVector)); Console.WriteLine("\n");
 
     // best beta values found so far
     auto bestBvector = VectorDuplicate( bVector );
 
-    auto pVector = ConstructProbVector( xMatrix, bVector ); // a column vector of the probabilities of each row using the b[i] values and the x[i] values.
-                                                            //Console.WriteLine("The initial Prob vector is: ");
-                                                            //Console.WriteLine(VectorAsString(pVector)); Console.WriteLine("\n");
+    // for the current b, filled by a single pass of SWLRKernel :
+    auto pVector = VectorCreate( xRows ); // a column vector of the probabilities of each row using the b[i] values and the x[i] values.
+    auto wVector = VectorCreate( xRows ); // p(1-p), the diagonal of W
+    auto rVector = VectorCreate( xRows ); // y - p
+    FSWLRKernelStats stats;
+    SWLRKernel::Evaluate( data, bVector.GetData(), pVector.GetData(), wVector.GetData(), rVector.GetData(), stats );
 
     //float[][] wMatrix = ConstructWeightMatrix(pVector); // deprecated. not needed if we use a shortct to comput WX. See ComputeXtilde.
     //Console.WriteLine("The initial Weight matrix is: ");
     //Console.WriteLine(MatrixAsString(wMatrix)); Console.WriteLine("\n");
 
-    auto mse = MeanSquaredError( pVector, yVector );
+    auto mse = stats.MeanSquaredError();
     auto timesWorse = 0; // how many times are the new betas worse (i.e., give worse MSE) than the current betas
 
     for ( auto i = 0; i < maxIterations; ++i )
@@ -133,9 +253,18 @@ TArray< float > SWLogisticRegression::ComputeBestBeta( TArray< TArray< float > >
         //Console.WriteLine("=================================");
         //Console.WriteLine(i);
 
-        auto newBvector = ConstructNewBetaVector( bVector, xMatrix, yVector, pVector ); // generate new beta values using Newton-Raphson. could return null.
+        TArray< float > newBvector; // generate new beta values using Newton-Raphson. could be empty.
+        auto pivot = 0;
+        if ( solver == ESWNewtonSolver::LU_INVERSE )
+            newBvector = ConstructNewBetaVector( bVector, xMatrix, yVector, pVector );
+        else if ( !ConstructNewBetaVectorLDLT( bVector, data, wVector, rVector, newBvector, pivot ) )
+            newBvector.Reset();
+
         if ( newBvector.Num() == 0 )
         {
+            if ( failedPivot != nullptr )
+                *failedPivot = pivot;
+
             //Console.WriteLine("The ConstructNewBetaVector() helper method in LogisticRegressionNewtonParameters() returned null");
             //Console.WriteLine("because the MatrixInverse() helper method in ConstructNewBetaVector returned null");
             //Console.WriteLine("because the current (X'X~) product could not be inverted");
@@ -162,10 +291,10 @@ TArray< float > SWLogisticRegression::ComputeBestBeta( TArray< TArray< float > >
             return bestBvector;
         }
 
-        pVector = ConstructProbVector( xMatrix, newBvector );
+        SWLRKernel::Evaluate( data, newBvector.GetData(), pVector.GetData(), wVector.GetData(), rVector.GetData(), stats );
 
         // are we getting worse or better?
-        const auto newMSE = MeanSquaredError( pVector, yVector ); // smaller is better
+        const auto newMSE = stats.MeanSquaredError(); // smaller is better
         if ( newMSE > mse )                                   // new MSE is worse than current SSD
         {
             ++timesWorse; // update counter
@@ -207,7 +336,7 @@ TArray< float > SWLogisticRegression::ComputeBestBeta( TArray< TArray< float > >
 
 // --------------------------------------------------------------------------------------------
 
-TArray< float > SWLogisticRegression::ConstructNewBetaVector( TArray< float > & oldBetaVector, TArray< TArray< float > > & xMatrix, TArray< float > & yVector, TArray< float > & oldProbVector )
+TArray< float > SWLogisticRegression::ConstructNewBetaVector( TArray< float > & oldBetaVector, const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & oldProbVector )
 {
     // this is the heart of the Newton-Raphson technique
     // b[t] = b[t-1] + inv(X'W[t-1]X)X'(y - p[t-1])
@@ -228,7 +357,7 @@ TArray< float > SWLogisticRegression::ConstructNewBetaVector( TArray< float > &
     auto B = MatrixProduct( Xt, A );                  // X'WX
 
     auto C = MatrixInverse( B ); // inv(X'WX)
-    if ( C.Num() == 0 )          // computing the inverse can blow up easily
+    if ( C.IsEmpty() )           // computing the inverse can blow up easily
         return TArray< float >();
 
     auto D = MatrixProduct( C, Xt );                       // inv(X'WX)X'
@@ -241,7 +370,428 @@ TArray< float > SWLogisticRegression::ConstructNewBetaVector( TArray< float > &
 
 // --------------------------------------------------------------------------------------------
 
-TArray< TArray< float > > SWLogisticRegression::ComputeXtilde( TArray< float > & pVector, TArray< TArray< float > > & xMatrix )
+namespace
+{
+    // solves Hd = g for the fixed size Newton step. h is P x P row-major with only its lower triangle filled.
+    // the general case goes through SolveSymmetric, which needs no heap allocation for such small sizes.
+    template< int P >
+    bool SolveNewtonStep( double ( &h )[ P * P ], double ( &g )[ P ], int & failedPivot )
+    {
+        return SWLogisticRegression::SolveSymmetric( h, g, P, failedPivot );
+    }
+
+    // 2 x 2 : [a b; b c]^-1 = [c -b; -b a] / (ac - b^2)
+    template<>
+    bool SolveNewtonStep< 2 >( double ( &h )[ 4 ], double ( &g )[ 2 ], int & failedPivot )
+    {
+        const auto a = h[ 0 ];
+        const auto b = h[ 2 ];
+        const auto c = h[ 3 ];
+        const auto det = a * c - b * b;
+        const auto scale = FMath::Max( a, c );
+        if ( !( det > 1e-12 * scale * scale ) ) // near-singular : let the regularized LDL' handle it
+            return SWLogisticRegression::SolveSymmetric( h, g, 2, failedPivot );
+
+        const auto g0 = g[ 0 ];
+        const auto g1 = g[ 1 ];
+        g[ 0 ] = ( c * g0 - b * g1 ) / det;
+        g[ 1 ] = ( a * g1 - b * g0 ) / det;
+        failedPivot = -1;
+        return true;
+    }
+
+    // 3 x 3 : inverse of [a d e; d b f; e f c] through its adjugate (symmetric too)
+    template<>
+    bool SolveNewtonStep< 3 >( double ( &h )[ 9 ], double ( &g )[ 3 ], int & failedPivot )
+    {
+        const auto a = h[ 0 ];
+        const auto d = h[ 3 ];
+        const auto b = h[ 4 ];
+        const auto e = h[ 6 ];
+        const auto f = h[ 7 ];
+        const auto c = h[ 8 ];
+
+        const auto adj00 = b * c - f * f;
+        const auto adj01 = e * f - d * c;
+        const auto adj02 = d * f - b * e;
+        const auto adj11 = a * c - e * e;
+        const auto adj12 = d * e - a * f;
+        const auto adj22 = a * b - d * d;
+        const auto det = a * adj00 + d * adj01 + e * adj02;
+        const auto scale = FMath::Max( a, FMath::Max( b, c ) );
+        if ( !( det > 1e-12 * scale * scale * scale ) )
+            return SWLogisticRegression::SolveSymmetric( h, g, 3, failedPivot );
+
+        const auto g0 = g[ 0 ];
+        const auto g1 = g[ 1 ];
+        const auto g2 = g[ 2 ];
+        g[ 0 ] = ( adj00 * g0 + adj01 * g1 + adj02 * g2 ) / det;
+        g[ 1 ] = ( adj01 * g0 + adj11 * g1 + adj12 * g2 ) / det;
+        g[ 2 ] = ( adj02 * g0 + adj12 * g1 + adj22 * g2 ) / det;
+        failedPivot = -1;
+        return true;
+    }
+}
+
+template< int NumVars >
+TArray< float > SWLogisticRegression::ComputeBestBetaFixed( const FSWMatrixView & xMatrix, TArray< float > & yVector, const int maxIterations, const float epsilon, const float jumpFactor, int * failedPivot, const TArray< float > & initialBetas )
+{
+    if ( xMatrix.Rows != yVector.Num() )
+        throw new std::exception( "The xMatrix and yVector are not compatible in ComputeBestBetaFixed()" );
+
+    return ComputeBestBetaFixed< NumVars >( FSWDataView( xMatrix, yVector.GetData() ), maxIterations, epsilon, jumpFactor, failedPivot, initialBetas );
+}
+
+template< int NumVars >
+TArray< float > SWLogisticRegression::ComputeBestBetaFixed( const FSWDataView & data, const int maxIterations, const float epsilon, const float jumpFactor, int * failedPivot, const TArray< float > & initialBetas )
+{
+    // same algorithm as ComputeBestBeta with the CHOLESKY solver, for xMatrix.Cols == NumVars + 1 known at compile time.
+    // beta vectors, X'WX and X'(y - p) are fixed size arrays on the stack, every loop over the columns has a constant
+    // trip count (unrolled by the compiler) and the 2 x 2 and 3 x 3 Newton systems are solved in closed form.
+    const int P = NumVars + 1;
+
+    if ( failedPivot != nullptr )
+        *failedPivot = -1;
+
+    if ( data.Num() == 0 )
+        return TArray< float >();
+
+    const auto xRows = data.Num();
+    if ( data.Cols() != P || data.YVector == nullptr )
+        throw new std::exception( "The xMatrix and yVector are not compatible in ComputeBestBetaFixed()" );
+
+    float bVector[ P ] = {};     // initialize to 0.0 or to initialBetas, like ComputeBestBeta
+    float bestBvector[ P ] = {}; // best beta values found so far
+    float newBvector[ P ];
+    if ( IsValidStart( initialBetas, P ) )
+    {
+        for ( auto j = 0; j < P; ++j )
+        {
+            bVector[ j ] = initialBetas[ j ];
+            bestBvector[ j ] = initialBetas[ j ];
+        }
+    }
+
+    // p(1-p) and y - p for the current b. inline storage covers the usual window of attempts
+    TArray< float, TInlineAllocator< 256 > > wVector;
+    TArray< float, TInlineAllocator< 256 > > rVector;
+    wVector.AddUninitialized( xRows );
+    rVector.AddUninitialized( xRows );
+
+    FSWLRKernelStats stats;
+    SWLRKernel::Evaluate( data, bVector, nullptr, wVector.GetData(), rVector.GetData(), stats );
+    auto mse = stats.MeanSquaredError();
+    auto timesWorse = 0;
+
+    for ( auto iteration = 0; iteration < maxIterations; ++iteration )
+    {
+        // X'WX (lower triangle) and X'(y - p) in one pass
+        double hessian[ P * P ] = {};
+        double step[ P ] = {};
+        for ( auto i = 0; i < xRows; ++i )
+        {
+            const auto * xRow = data.Row( i );
+            const double w = wVector[ i ];
+            const double r = rVector[ i ];
+            for ( auto j = 0; j < P; ++j )
+            {
+                const auto wxj = w * xRow[ j ];
+                for ( auto k = 0; k <= j; ++k )
+                    hessian[ j * P + k ] += wxj * xRow[ k ];
+                step[ j ] += xRow[ j ] * r;
+            }
+        }
+
+        auto pivot = -1;
+        if ( !SolveNewtonStep< P >( hessian, step, pivot ) )
+        {
+            if ( failedPivot != nullptr )
+                *failedPivot = pivot;
+            break;
+        }
+
+        auto noChange = true;
+        auto outOfControl = false;
+        for ( auto j = 0; j < P; ++j )
+        {
+            newBvector[ j ] = bVector[ j ] + step[ j ];
+            noChange = noChange && FMath::Abs( bVector[ j ] - newBvector[ j ] ) <= epsilon;
+        }
+        for ( auto j = 0; j < P; ++j ) // see OutOfControl
+        {
+            if ( bVector[ j ] == 0.0f )
+                break;
+            if ( FMath::Abs( bVector[ j ] - newBvector[ j ] ) / FMath::Abs( bVector[ j ] ) > jumpFactor )
+            {
+                outOfControl = true;
+                break;
+            }
+        }
+        if ( noChange || outOfControl )
+            break;
+
+        SWLRKernel::Evaluate( data, newBvector, nullptr, wVector.GetData(), rVector.GetData(), stats );
+        const auto newMSE = stats.MeanSquaredError();
+
+        // the current b always moves to the new values (ComputeBestBeta does the same), only the best b depends on the MSE
+        for ( auto j = 0; j < P; ++j )
+            bVector[ j ] = newBvector[ j ];
+
+        if ( newMSE > mse )
+        {
+            ++timesWorse;
+            if ( timesWorse >= 4 )
+                break;
+        }
+        else
+        {
+            for ( auto j = 0; j < P; ++j )
+                bestBvector[ j ] = bVector[ j ];
+            timesWorse = 0;
+        }
+        mse = newMSE;
+    }
+
+    return TArray< float >( bestBvector, P );
+}
+
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 1 >( const FSWMatrixView & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 2 >( const FSWMatrixView & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 3 >( const FSWMatrixView & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 1 >( const FSWDataView & data, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 2 >( const FSWDataView & data, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+template TArray< float > SWLogisticRegression::ComputeBestBetaFixed< 3 >( const FSWDataView & data, int maxIterations, float epsilon, float jumpFactor, int * failedPivot, const TArray< float > & initialBetas );
+
+// --------------------------------------------------------------------------------------------
+
+bool SWLogisticRegression::ConstructNewBetaVectorLDLT( TArray< float > & oldBetaVector, const FSWDataView & data, TArray< float > & oldWeightVector, TArray< float > & oldResidualVector, TArray< float > & newBetaVector, int & failedPivot )
+{
+    // same Newton-Raphson step as ConstructNewBetaVector : b[t] = b[t-1] + inv(X'WX)X'(y - p[t-1])
+    // but X', WX and inv(X'WX) are never built.
+    // oldWeightVector is p(1-p) (the diagonal of W) and oldResidualVector is y - p, as computed by SWLRKernel.
+    // X'WX (p x p) and X'(y - p) (p x 1) are accumulated in a single pass over the rows of X,
+    // then the step d is found by solving the small symmetric system (X'WX)d = X'(y - p).
+    // returns false if X'WX could not be factored, failedPivot then tells which pivot broke down.
+
+    const auto xRows = data.Num();
+    const auto xCols = data.Cols();
+    if ( xRows != oldWeightVector.Num() || xRows != oldResidualVector.Num() || xCols != oldBetaVector.Num() )
+        throw new std::exception( "Non-conformable arguments in ConstructNewBetaVectorLDLT" );
+
+    // accumulated in double : the system is tiny and X'WX is often badly conditioned
+    TArray< double, TInlineAllocator< 64 > > hessian; // X'WX, only the lower triangle is filled
+    hessian.AddZeroed( xCols * xCols );
+    TArray< double, TInlineAllocator< 8 > > step; // X'(y - p), then the Newton step once solved
+    step.AddZeroed( xCols );
+
+    for ( auto i = 0; i < xRows; ++i )
+    {
+        const auto * xRow = data.Row( i );
+        const double w = oldWeightVector[ i ];
+        const double r = oldResidualVector[ i ];
+        for ( auto j = 0; j < xCols; ++j )
+        {
+            const auto wxj = w * xRow[ j ];
+            auto * hessianRow = hessian.GetData() + j * xCols;
+            for ( auto k = 0; k <= j; ++k )
+                hessianRow[ k ] += wxj * xRow[ k ];
+            step[ j ] += xRow[ j ] * r;
+        }
+    }
+
+    if ( !SolveSymmetric( hessian.GetData(), step.GetData(), xCols, failedPivot ) )
+        return false;
+
+    newBetaVector.Reset( xCols );
+    for ( auto j = 0; j < xCols; ++j )
+        newBetaVector.Add( oldBetaVector[ j ] + step[ j ] );
+
+    return true;
+}
+
+bool SWLogisticRegression::SolveSymmetric( double * matrix, double * vector, const int n, int & failedPivot )
+{
+    // solves Ax = b in place for a symmetric positive (semi-)definite A, such as X'WX.
+    // matrix is n x n row-major and only its lower triangle is read. it is overwritten by the factorization.
+    // vector holds b on input and x on output.
+    // returns false if A can not be factored (see FactorSymmetric) : failedPivot is then the index of the bad pivot.
+
+    if ( !FactorSymmetric( matrix, n, failedPivot ) )
+        return false;
+
+    SolveFactored( matrix, vector, n );
+    return true;
+}
+
+bool SWLogisticRegression::FactorSymmetric( double * matrix, const int n, int & failedPivot )
+{
+    // A = LDL' in place, with 1.0s on L diagonal (no square roots, unlike Cholesky).
+    // matrix is n x n row-major and only its lower triangle is read. on output, the strict lower triangle holds L
+    // and the diagonal holds D.
+    // a pivot of D is rejected if it is not clearly positive relatively to the largest diagonal value of A.
+    // near-singular matrices (collinear variables, separated data) get a small ridge added to their
+    // diagonal and are factored again, instead of failing like MatrixInverse does.
+    // returns false if A can not be factored even after regularization : failedPivot is then the index of the bad pivot.
+
+    failedPivot = -1;
+
+    auto maxDiag = 0.0;
+    for ( auto i = 0; i < n; ++i )
+        maxDiag = FMath::Max( maxDiag, matrix[ i * n + i ] );
+    if ( !( maxDiag > 0.0 ) ) // also catches NaN
+    {
+        failedPivot = 0;
+        return false;
+    }
+
+    TArray< double, TInlineAllocator< 64 > > original;
+    original.Append( matrix, n * n );
+
+    const double ridges[] = { 0.0, 1e-10, 1e-7, 1e-4 };
+    for ( const auto ridge : ridges )
+    {
+        if ( ridge > 0.0 )
+        {
+            FMemory::Memcpy( matrix, original.GetData(), n * n * sizeof( double ) );
+            for ( auto i = 0; i < n; ++i )
+                matrix[ i * n + i ] += ridge * maxDiag;
+        }
+
+        failedPivot = -1;
+        for ( auto j = 0; j < n && failedPivot < 0; ++j )
+        {
+            auto * rowJ = matrix + j * n;
+            auto dj = rowJ[ j ];
+            for ( auto k = 0; k < j; ++k )
+                dj -= rowJ[ k ] * rowJ[ k ] * matrix[ k * n + k ];
+
+            if ( !( dj > maxDiag * 1e-12 ) )
+            {
+                failedPivot = j;
+                break;
+            }
+            rowJ[ j ] = dj;
+
+            for ( auto i = j + 1; i < n; ++i )
+            {
+                auto * rowI = matrix + i * n;
+                auto lij = rowI[ j ];
+                for ( auto k = 0; k < j; ++k )
+                    lij -= rowI[ k ] * rowJ[ k ] * matrix[ k * n + k ];
+                rowI[ j ] = lij / dj;
+            }
+        }
+
+        if ( failedPivot < 0 )
+            break;
+    }
+
+    return failedPivot < 0;
+}
+
+void SWLogisticRegression::SolveFactored( const double * factored, double * vector, const int n )
+{
+    // solves LDL'x = b in place, factored being the output of FactorSymmetric.
+    // O(n^2) : the factorization can be reused for several right-hand sides.
+
+    const auto * matrix = factored;
+
+    // Lz = b, forward
+    for ( auto i = 1; i < n; ++i )
+    {
+        const auto * rowI = matrix + i * n;
+        for ( auto k = 0; k < i; ++k )
+            vector[ i ] -= rowI[ k ] * vector[ k ];
+    }
+
+    // Dy = z
+    for ( auto i = 0; i < n; ++i )
+        vector[ i ] /= matrix[ i * n + i ];
+
+    // L'x = y, backward
+    for ( auto i = n - 2; i >= 0; --i )
+    {
+        for ( auto k = i + 1; k < n; ++k )
+            vector[ i ] -= matrix[ k * n + i ] * vector[ k ];
+    }
+}
+
+// --------------------------------------------------------------------------------------------
+
+float SWLogisticRegression::ApproxLOOAccuracy( const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & bVector )
+{
+    // returns the percent (as 0.00 to 100.00) of rows correctly predicted by a model fitted without them (leave-one-out),
+    // without refitting : bVector must be the betas fitted on all the rows.
+    // one Newton step from bVector removing row i gives b(-i) = b - inv(H) x[i] r[i] / (1 - h[i])
+    // with H = X'WX, r = y - p, q[i] = x[i]' inv(H) x[i] and h[i] = w[i] q[i] (leverage of row i). so :
+    //  z(-i) = x[i].b(-i) = z[i] - q[i] r[i] / (1 - h[i])
+    // and row i is correctly predicted if z(-i) >= 0 (p >= 0.5) when y[i] is 1, z(-i) < 0 when y[i] is 0.
+    // costs one pass to build H and one pass with a p x p triangular solve per row, instead of one fit per fold.
+
+    if ( xMatrix.Num() == 0 || yVector.Num() == 0 || bVector.Num() == 0 )
+        return 0;
+
+    const auto xRows = xMatrix.Rows;
+    const auto xCols = xMatrix.Cols;
+    if ( xCols != bVector.Num() || xRows != yVector.Num() )
+        throw new std::exception( "Bad dimensions for xMatrix or yVector or bVector in ApproxLOOAccuracy()" );
+
+    TArray< float > wVector;
+    TArray< float > rVector;
+    wVector.AddUninitialized( xRows );
+    rVector.AddUninitialized( xRows );
+    FSWLRKernelStats stats;
+    SWLRKernel::Evaluate( xMatrix, yVector.GetData(), bVector.GetData(), nullptr, wVector.GetData(), rVector.GetData(), stats );
+
+    TArray< double, TInlineAllocator< 64 > > hessian; // X'WX, lower triangle
+    hessian.AddZeroed( xCols * xCols );
+    for ( auto i = 0; i < xRows; ++i )
+    {
+        const auto * xRow = xMatrix.Row( i );
+        const double w = wVector[ i ];
+        for ( auto j = 0; j < xCols; ++j )
+        {
+            const auto wxj = w * xRow[ j ];
+            auto * hessianRow = hessian.GetData() + j * xCols;
+            for ( auto k = 0; k <= j; ++k )
+                hessianRow[ k ] += wxj * xRow[ k ];
+        }
+    }
+
+    auto failedPivot = -1;
+    if ( !FactorSymmetric( hessian.GetData(), xCols, failedPivot ) )
+        return 0;
+
+    TArray< double, TInlineAllocator< 8 > > hx; // inv(H) x[i]
+    hx.AddUninitialized( xCols );
+    auto nbCorrect = 0;
+    for ( auto i = 0; i < xRows; ++i )
+    {
+        const auto * xRow = xMatrix.Row( i );
+        auto z = 0.0;
+        for ( auto j = 0; j < xCols; ++j )
+        {
+            hx[ j ] = xRow[ j ];
+            z += xRow[ j ] * bVector[ j ];
+        }
+        SolveFactored( hessian.GetData(), hx.GetData(), xCols );
+
+        auto q = 0.0;
+        for ( auto j = 0; j < xCols; ++j )
+            q += xRow[ j ] * hx[ j ];
+
+        // h < 1 in exact arithmetic, guard against rounding on rows with a huge leverage
+        const auto h = FMath::Min( wVector[ i ] * q, 1.0 - 1e-6 );
+        const auto zLoo = z - q * rVector[ i ] / ( 1.0 - h );
+
+        if ( ( zLoo >= 0.0 && yVector[ i ] == 1.0f ) || ( zLoo < 0.0 && yVector[ i ] == 0.0f ) )
+            ++nbCorrect;
+    }
+
+    return ( 100.0 * nbCorrect ) / xRows;
+}
+
+FSWMatrix SWLogisticRegression::ComputeXtilde( TArray< float > & pVector, const FSWMatrixView & xMatrix )
 {
     // note: W[t-1] is nxn which could be huge so instead of computing b[t] = b[t-1] + inv(X'W[t-1]X)X'(y - p[t-1]) directly
     // we compute the W[t-1]X part, without the use of W.
@@ -251,8 +801,8 @@ TArray< TArray< float > > SWLogisticRegression::ComputeXtilde( TArray< float > &
     // ex: if xMatrix is 10x4 then W would be 10x10 so WX would be 10x4 -- the same size as X
 
     const auto pRows = pVector.Num();
-    const auto xRows = xMatrix.Num();
-    const auto xCols = xMatrix[ 0 ].Num();
+    const auto xRows = xMatrix.Rows;
+    const auto xCols = xMatrix.Cols;
 
     if ( pRows != xRows )
         throw new std::exception( "The pVector and xMatrix are not compatible in ComputeXtilde" );
@@ -262,9 +812,12 @@ TArray< TArray< float > > SWLogisticRegression::ComputeXtilde( TArray< float > &
 
     for ( auto i = 0; i < pRows; ++i )
     {
+        const auto * xRow = xMatrix.Row( i );
+        auto * resultRow = result.Row( i );
+        const auto w = pVector[ i ] * ( 1.0 - pVector[ i ] ); // note the p(1-p)
         for ( auto j = 0; j < xCols; ++j )
         {
-            result[ i ][ j ] = pVector[ i ] * ( 1.0 - pVector[ i ] ) * xMatrix[ i ][ j ]; // note the p(1-p)
+            resultRow[ j ] = w * xRow[ j ];
         }
     } // i
     return result;
@@ -272,6 +825,19 @@ TArray< TArray< float > > SWLogisticRegression::ComputeXtilde( TArray< float > &
 
 // --------------------------------------------------------------------------------------------
 
+bool SWLogisticRegression::IsValidStart( const TArray< float > & initialBetas, const int nbBetas )
+{
+    // a previous fit can be used as a starting point if it has the right size and did not blow up
+    if ( initialBetas.Num() != nbBetas )
+        return false;
+    for ( const auto beta : initialBetas )
+    {
+        if ( !FMath::IsFinite( beta ) )
+            return false;
+    }
+    return true;
+}
+
 bool SWLogisticRegression::NoChange( TArray< float > & oldBvector, TArray< float > & newBvector, const float epsilon )
 {
     // true if all new b values have changed by amount smaller than epsilon
@@ -299,15 +865,15 @@ bool SWLogisticRegression::OutOfControl( TArray< float > & oldBvector, TArray< f
 
 // --------------------------------------------------------------------------------------------
 
-TArray< float > SWLogisticRegression::ConstructProbVector( TArray< TArray< float > > & xMatrix, TArray< float > & bVector )
+TArray< float > SWLogisticRegression::ConstructProbVector( const FSWMatrixView & xMatrix, TArray< float > & bVector )
 {
     // p = 1 / (1 + exp(-z) where z = b0x0 + b1x1 + b2x2 + b3x3 + . . .
     // suppose X is 10 x 4 (cols are: x0 = const. 1.0, x1, x2, x3)
     // then b would be a 4 x 1 (col vecror)
     // then result of X times b is (10x4)(4x1) = (10x1) column vector
 
-    const auto xRows = xMatrix.Num();
-    const auto xCols = xMatrix[ 0 ].Num();
+    const auto xRows = xMatrix.Rows;
+    const auto xCols = xMatrix.Cols;
     const auto bRows = bVector.Num();
 
     if ( xCols != bRows )
@@ -315,19 +881,9 @@ TArray< float > SWLogisticRegression::ConstructProbVector( TArray< TArray< float
 
     auto result = VectorCreate( xRows ); // ex: if xMatrix is size 10 x 4 and bVector is 4 x 1 then prob vector is 10 x 1 (one prob for every row of xMatrix)
 
-    float z = 0.0;
-    float p = 0.0;
+    FSWLRKernelStats stats; // vectorized sigmoid, no y so nothing else is computed
+    SWLRKernel::Evaluate( xMatrix, nullptr, bVector.GetData(), result.GetData(), nullptr, nullptr, stats );
 
-    for ( auto i = 0; i < xRows; ++i )
-    {
-        z = 0.0;
-        for ( auto j = 0; j < xCols; ++j )
-        {
-            z += xMatrix[ i ][ j ] * bVector[ j ]; // b0(1.0) + b1x1 + b2x2 + . . .
-        }
-        p = 1.0 / ( 1.0 + FMath::Exp( -z ) ); // consider checking for huge value of Math.Exp(-z) here
-        result[ i ] = p;
-    }
     return result;
 }
 
@@ -356,21 +912,10 @@ float SWLogisticRegression::MeanSquaredError( TArray< float > & pVector, TArray<
 
 // ============================================================================================
 
-TArray< TArray< float > > SWLogisticRegression::MatrixCreate( const int rows, const int cols )
+FSWMatrix SWLogisticRegression::MatrixCreate( const int rows, const int cols )
 {
-    // creates a matrix initialized to all 0.0. assume rows and cols > 0
-    TArray< TArray< float > > result;
-    result.Reserve( rows );
-    for ( auto i = 0; i < rows; ++i )
-    {
-        result.Add( TArray<float>() );
-        result[ i ].Reserve( cols );
-        for (auto j = 0; j < cols; j++)
-        {
-            result[i].Add(0);
-        }
-    } // explicit initialization not necessary.
-    return result;
+    // creates a matrix initialized to all 0.0, stored in one contiguous block
+    return FSWMatrix( rows, cols );
 }
 
 TArray< float > SWLogisticRegression::VectorCreate( const int rows )
@@ -398,13 +943,13 @@ TArray< float > SWLogisticRegression::VectorCreate( const int rows )
 //     return s;
 // }
 
-TArray< TArray< float > > SWLogisticRegression::MatrixDuplicate( TArray< TArray< float > > & matrix )
+FSWMatrix SWLogisticRegression::MatrixDuplicate( const FSWMatrixView & matrix )
 {
-    // allocates/creates a duplicate of a matrix. assumes matrix is not null.
-    auto result = MatrixCreate( matrix.Num(), matrix[ 0 ].Num() );
-    for ( auto i = 0; i < matrix.Num(); ++i ) // copy the values
-        for ( auto j = 0; j < matrix[ i ].Num(); ++j )
-            result[ i ][ j ] = matrix[ i ][ j ];
+    // allocates/creates a duplicate of a matrix (the copy is always packed, whatever the stride of the view)
+    FSWMatrix result;
+    result.SetSizeUninitialized( matrix.Rows, matrix.Cols );
+    for ( auto i = 0; i < matrix.Rows; ++i ) // copy the values
+        FMemory::Memcpy( result.Row( i ), matrix.Row( i ), matrix.Cols * sizeof( float ) );
     return result;
 }
 
@@ -452,44 +997,55 @@ TArray< float > SWLogisticRegression::VectorDuplicate( TArray< float > & vector
     return result;
 }
 
-TArray< TArray< float > > SWLogisticRegression::MatrixTranspose( TArray< TArray< float > > & matrix )
+FSWMatrix SWLogisticRegression::MatrixTranspose( const FSWMatrixView & matrix )
 {
-    const auto rows = matrix.Num();
-    const auto cols = matrix[ 0 ].Num();             // assume all columns have equal size
-    auto result = MatrixCreate( cols, rows ); // note the indexing swap
+    const auto rows = matrix.Rows;
+    const auto cols = matrix.Cols;
+    FSWMatrix result;
+    result.SetSizeUninitialized( cols, rows ); // note the indexing swap
     for ( auto i = 0; i < rows; ++i )
     {
+        const auto * row = matrix.Row( i );
         for ( auto j = 0; j < cols; ++j )
         {
-            result[ j ][ i ] = matrix[ i ][ j ];
+            result( j, i ) = row[ j ];
         }
     }
     return result;
 }
 
-TArray< TArray< float > > SWLogisticRegression::MatrixProduct( TArray< TArray< float > > & matrixA, TArray< TArray< float > > & matrixB )
+FSWMatrix SWLogisticRegression::MatrixProduct( const FSWMatrixView & matrixA, const FSWMatrixView & matrixB )
 {
-    const auto aRows = matrixA.Num();
-    const auto aCols = matrixA[ 0 ].Num();
-    const auto bRows = matrixB.Num();
-    const auto bCols = matrixB[ 0 ].Num();
+    const auto aRows = matrixA.Rows;
+    const auto aCols = matrixA.Cols;
+    const auto bRows = matrixB.Rows;
+    const auto bCols = matrixB.Cols;
     if ( aCols != bRows )
         throw new std::exception( "Non-conformable matrices in MatrixProduct" );
 
     auto result = MatrixCreate( aRows, bCols );
 
-    for ( auto i = 0; i < aRows; ++i )         // each row of A
-        for ( auto j = 0; j < bCols; ++j )     // each col of B
-            for ( auto k = 0; k < aCols; ++k ) // could use k < bRows
-                result[ i ][ j ] += matrixA[ i ][ k ] * matrixB[ k ][ j ];
+    // i-k-j order: the inner loop walks one row of B and one row of the result, both contiguous
+    for ( auto i = 0; i < aRows; ++i ) // each row of A
+    {
+        const auto * aRow = matrixA.Row( i );
+        auto * resultRow = result.Row( i );
+        for ( auto k = 0; k < aCols; ++k ) // could use k < bRows
+        {
+            const auto aik = aRow[ k ];
+            const auto * bRow = matrixB.Row( k );
+            for ( auto j = 0; j < bCols; ++j ) // each col of B
+                resultRow[ j ] += aik * bRow[ j ];
+        }
+    }
 
     return result;
 }
 
-TArray< float > SWLogisticRegression::MatrixVectorProduct( TArray< TArray< float > > & matrix, TArray< float > & vector )
+TArray< float > SWLogisticRegression::MatrixVectorProduct( const FSWMatrixView & matrix, TArray< float > & vector )
 {
-    const auto mRows = matrix.Num();
-    const auto mCols = matrix[ 0 ].Num();
+    const auto mRows = matrix.Rows;
+    const auto mCols = matrix.Cols;
     const auto vRows = vector.Num();
     if ( mCols != vRows )
         throw new std::exception( "Non-conformable matrix and vector in MatrixVectorProduct" );
@@ -497,28 +1053,30 @@ TArray< float > SWLogisticRegression::MatrixVectorProduct( TArray< TArray< float
     result.Reserve( mRows ); // an n x m matrix times a m x 1 column vector is a n x 1 column vector
     for ( auto i = 0; i < mRows; ++i )
     {
+        const auto * row = matrix.Row( i );
         result.Add(0);
         for ( auto j = 0; j < mCols; ++j )
-            result[ i ] += matrix[ i ][ j ] * vector[ j ];
+            result[ i ] += row[ j ] * vector[ j ];
     }
     return result;
 }
 
-TArray< TArray< float > > SWLogisticRegression::MatrixInverse( TArray< TArray< float > > & matrix )
+FSWMatrix SWLogisticRegression::MatrixInverse( const FSWMatrixView & matrix )
 {
-    const auto n = matrix.Num();
+    const auto n = matrix.Rows;
     auto result = MatrixDuplicate( matrix );
 
     TArray< int > perm;
     int toggle;
     auto lum = MatrixDecompose( matrix, perm, toggle );
-    if ( lum.Num() == 0 )
-        return TArray< TArray< float > >();
+    if ( lum.IsEmpty() )
+        return FSWMatrix();
 
     TArray< float > b;
     b.Reserve( n );
     for ( auto i = 0; i < n; ++i )
     {
+        b.Reset(); // one permuted unit vector per column of the inverse
         for ( auto j = 0; j < n; ++j )
         {
             if ( i == perm[ j ] )
@@ -530,15 +1088,15 @@ TArray< TArray< float > > SWLogisticRegression::MatrixInverse( TArray< TArray< f
         auto x = HelperSolve( lum, b ); //
 
         for ( auto j = 0; j < n; ++j )
-            result[ j ][ i ] = x[ j ];
+            result( j, i ) = x[ j ];
     }
     return result;
 }
 
-TArray< float > SWLogisticRegression::HelperSolve( TArray< TArray< float > > & luMatrix, TArray< float > & b )
+TArray< float > SWLogisticRegression::HelperSolve( const FSWMatrixView & luMatrix, TArray< float > & b )
 {
     // solve Ax = b if you already have luMatrix from A and b has been permuted
-    const auto n = luMatrix.Num();
+    const auto n = luMatrix.Rows;
 
     // 1. make a copy of the permuted b vector
     TArray< float > x;
@@ -549,24 +1107,26 @@ TArray< float > SWLogisticRegression::HelperSolve( TArray< TArray< float > > & l
     // 2. solve Ly = b using forward substitution
     for ( auto i = 1; i < n; ++i )
     {
+        const auto * luRow = luMatrix.Row( i );
         auto sum = x[ i ];
         for ( auto j = 0; j < i; ++j )
         {
-            sum -= luMatrix[ i ][ j ] * x[ j ];
+            sum -= luRow[ j ] * x[ j ];
         }
         x[ i ] = sum;
     }
 
     // 3. solve Ux = y using backward substitution
-    x[ n - 1 ] /= luMatrix[ n - 1 ][ n - 1 ];
+    x[ n - 1 ] /= luMatrix( n - 1, n - 1 );
     for ( auto i = n - 2; i >= 0; --i )
     {
+        const auto * luRow = luMatrix.Row( i );
         auto sum = x[ i ];
         for ( auto j = i + 1; j < n; ++j )
         {
-            sum -= luMatrix[ i ][ j ] * x[ j ];
+            sum -= luRow[ j ] * x[ j ];
         }
-        x[ i ] = sum / luMatrix[ i ][ i ];
+        x[ i ] = sum / luRow[ i ];
     }
 
     return x;
@@ -574,11 +1134,11 @@ TArray< float > SWLogisticRegression::HelperSolve( TArray< TArray< float > > & l
 
 // -------------------------------------------------------------------------------------------------------------------
 
-TArray< TArray< float > > SWLogisticRegression::MatrixDecompose( TArray< TArray< float > > & matrix, TArray< int > & perm, int & tog )
+FSWMatrix SWLogisticRegression::MatrixDecompose( const FSWMatrixView & matrix, TArray< int > & perm, int & tog )
 {
     // Doolittle's method (1.0s on L diagonal) with partial pivoting
-    const auto rows = matrix.Num();
-    const auto cols = matrix[ 0 ].Num(); // assume all rows have the same number of columns so just use row [0].
+    const auto rows = matrix.Rows;
+    const auto cols = matrix.Cols;
     if ( rows != cols )
         throw new std::exception( "Attempt to MatrixDecompose a non-square matrix" );
 
@@ -598,11 +1158,11 @@ TArray< TArray< float > > SWLogisticRegression::MatrixDecompose( TArray< TArray<
 
     for ( auto j = 0; j < n - 1; ++j ) // each column
     {
-        auto max = FMath::Abs( result[ j ][ j ] ); // find largest value in row
+        auto max = FMath::Abs( result( j, j ) ); // find largest value in row
         auto pRow = j;
         for ( auto i = j + 1; i < n; ++i )
         {
-            aij = FMath::Abs( result[ i ][ j ] );
+            aij = FMath::Abs( result( i, j ) );
             if ( aij > max )
             {
                 max = aij;
@@ -612,9 +1172,7 @@ TArray< TArray< float > > SWLogisticRegression::MatrixDecompose( TArray< TArray<
 
         if ( pRow != j ) // if largest value not on pivot, swap rows
         {
-            const auto rowPtr = result[ pRow ];
-            result[ pRow ] = result[ j ];
-            result[ j ] = rowPtr;
+            FMemory::Memswap( result.Row( pRow ), result.Row( j ), n * sizeof( float ) );
 
             const auto tmp = perm[ pRow ]; // and swap perm info
             perm[ pRow ] = perm[ j ];
@@ -623,17 +1181,19 @@ TArray< TArray< float > > SWLogisticRegression::MatrixDecompose( TArray< TArray<
             tog = -tog; // adjust the row-swap toggle
         }
 
-        const auto ajj = result[ j ][ j ];
-        if ( FMath::Abs( ajj ) < 0.00000001f )   // if diagonal after swap is zero . . .
-            return TArray< TArray< float > >(); // consider a throw
+        const auto ajj = result( j, j );
+        if ( FMath::Abs( ajj ) < 0.00000001f ) // if diagonal after swap is zero . . .
+            return FSWMatrix();                 // consider a throw
 
+        const auto * rowJ = result.Row( j );
         for ( auto i = j + 1; i < n; ++i )
         {
-            aij = result[ i ][ j ] / ajj;
-            result[ i ][ j ] = aij;
+            auto * rowI = result.Row( i );
+            aij = rowI[ j ] / ajj;
+            rowI[ j ] = aij;
             for ( auto k = j + 1; k < n; ++k )
             {
-                result[ i ][ k ] -= aij * result[ j ][ k ];
+                rowI[ k ] -= aij * rowJ[ k ];
             }
         }
     } // main j loop
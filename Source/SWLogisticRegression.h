@@ -2,35 +2,67 @@
 
 #include <CoreMinimal.h>
 
+#include "SWDataView.h"
+#include "SWMatrix.h"
+
 class USWModelLR;
 class USWDataLR;
 
+//Methode utilisee pour calculer le pas de Newton-Raphson
+enum class ESWNewtonSolver : uint8
+{
+    LU_INVERSE, //X' et WX construits explicitement, X'WX inversee par LU (methode historique)
+    CHOLESKY    //X'WX et X'(y-p) accumules en une passe sur les lignes, puis resolution LDL'
+};
+
 class SWARMS_API SWLogisticRegression
 {
 public:
     //Le fichier doit contenir pour chaque lignes les valeurs des indépendants suivie de la dépendante
-    static USWModelLR * ComputeModel( USWDataLR * datas );
+    //initialBetas : point de depart de Newton-Raphson (ex : betas du dernier calcul), ignore s'il n'a pas la bonne taille
+    static USWModelLR * ComputeModel( USWDataLR * datas, ESWNewtonSolver solver = ESWNewtonSolver::CHOLESKY, const TArray< float > & initialBetas = TArray< float >() );
+    //Version specialisee pour NumVars variables (1, 2 ou 3 thetas), choisie automatiquement par ComputeModel
+    template< int NumVars >
+    static USWModelLR * ComputeModel( USWDataLR * datas, const TArray< float > & initialBetas = TArray< float >() );
+    //Comme ComputeModel mais sans UObject ni message a l'ecran : utilisable depuis un worker thread
+    static TArray< float > ComputeBetas( const FSWMatrixView & xMatrix, TArray< float > & yVector, int & failedPivot, ESWNewtonSolver solver = ESWNewtonSolver::CHOLESKY, const TArray< float > & initialBetas = TArray< float >() );
+    //Idem sur une vue (pli de validation croisee...) : les lignes sont lues en place, sans copie
+    static TArray< float > ComputeBetas( const FSWDataView & data, int & failedPivot, ESWNewtonSolver solver = ESWNewtonSolver::CHOLESKY, const TArray< float > & initialBetas = TArray< float >() );
     static float TestModel( USWModelLR * model, USWDataLR * testData );
-    static float PredictiveAccuracy( TArray< TArray< float > > & xMatrix, TArray< float > & yVector, TArray< float > & bVector );
-    static TArray< float > ComputeBestBeta( TArray< TArray< float > > & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor );
-    static TArray< float > ConstructNewBetaVector( TArray< float > & oldBetaVector, TArray< TArray< float > > & xMatrix, TArray< float > & yVector, TArray< float > & oldProbVector );
-    static TArray< TArray< float > > ComputeXtilde( TArray< float > & pVector, TArray< TArray< float > > & xMatrix );
+    static float TestModel( USWModelLR * model, const FSWDataView & testData );
+    static float PredictiveAccuracy( const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & bVector );
+    static float PredictiveAccuracy( const FSWDataView & data, const TArray< float > & bVector );
+    //Precision leave-one-out approchee a partir des betas calcules sur toutes les lignes (pas de nouvel apprentissage)
+    static float ApproxLOOAccuracy( const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & bVector );
+    static TArray< float > ComputeBestBeta( const FSWMatrixView & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor, ESWNewtonSolver solver = ESWNewtonSolver::CHOLESKY, int * failedPivot = nullptr, const TArray< float > & initialBetas = TArray< float >() );
+    static TArray< float > ComputeBestBeta( const FSWDataView & data, int maxIterations, float epsilon, float jumpFactor, ESWNewtonSolver solver = ESWNewtonSolver::CHOLESKY, int * failedPivot = nullptr, const TArray< float > & initialBetas = TArray< float >() );
+    static TArray< float > ConstructNewBetaVector( TArray< float > & oldBetaVector, const FSWMatrixView & xMatrix, TArray< float > & yVector, TArray< float > & oldProbVector );
+    template< int NumVars >
+    static TArray< float > ComputeBestBetaFixed( const FSWMatrixView & xMatrix, TArray< float > & yVector, int maxIterations, float epsilon, float jumpFactor, int * failedPivot = nullptr, const TArray< float > & initialBetas = TArray< float >() );
+    template< int NumVars >
+    static TArray< float > ComputeBestBetaFixed( const FSWDataView & data, int maxIterations, float epsilon, float jumpFactor, int * failedPivot = nullptr, const TArray< float > & initialBetas = TArray< float >() );
+    static bool ConstructNewBetaVectorLDLT( TArray< float > & oldBetaVector, const FSWDataView & data, TArray< float > & oldWeightVector, TArray< float > & oldResidualVector, TArray< float > & newBetaVector, int & failedPivot );
+    static bool SolveSymmetric( double * matrix, double * vector, int n, int & failedPivot );
+    static bool FactorSymmetric( double * matrix, int n, int & failedPivot );
+    static void SolveFactored( const double * factored, double * vector, int n );
+    static FSWMatrix ComputeXtilde( TArray< float > & pVector, const FSWMatrixView & xMatrix );
+    static bool IsValidStart( const TArray< float > & initialBetas, int nbBetas );
     static bool NoChange( TArray< float > & oldBvector, TArray< float > & newBvector, float epsilon );
     static bool OutOfControl( TArray< float > & oldBvector, TArray< float > & newBvector, float jumpFactor );
-    static TArray< float > ConstructProbVector( TArray< TArray< float > > & xMatrix, TArray< float > & bVector );
+    static TArray< float > ConstructProbVector( const FSWMatrixView & xMatrix, TArray< float > & bVector );
     static float MeanSquaredError( TArray< float > & pVector, TArray< float > & yVector );
-    static TArray< TArray< float > > MatrixCreate( int rows, int cols );
+    static FSWMatrix MatrixCreate( int rows, int cols );
     static TArray< float > VectorCreate( int rows );
     //static FString MatrixAsString( TArray< TArray< float > > matrix, int numRows, int digits, int width );
-    static TArray< TArray< float > > MatrixDuplicate( TArray< TArray< float > > & matrix );
+    static FSWMatrix MatrixDuplicate( const FSWMatrixView & matrix );
     static TArray< float > VectorAddition( TArray< float > & vectorA, TArray< float > & vectorB );
     static TArray< float > VectorSubtraction( TArray< float > & vectorA, TArray< float > & vectorB );
     //static FString VectorAsString( TArray< float > vector, int count, int digits, int width );
     static TArray< float > VectorDuplicate( TArray< float > & vector );
-    static TArray< TArray< float > > MatrixTranspose( TArray< TArray< float > > & matrix );
-    static TArray< TArray< float > > MatrixProduct( TArray< TArray< float > > & matrixA, TArray< TArray< float > > & matrixB );
-    static TArray< float > MatrixVectorProduct( TArray< TArray< float > > & matrix, TArray< float > & vector );
-    static TArray< TArray< float > > MatrixInverse( TArray< TArray< float > > & matrix );
-    static TArray< float > HelperSolve( TArray< TArray< float > > & luMatrix, TArray< float > & b );
-    static TArray< TArray< float > > MatrixDecompose( TArray< TArray< float > > & matrix, TArray< int > & perm, int & tog );
+    static FSWMatrix MatrixTranspose( const FSWMatrixView & matrix );
+    static FSWMatrix MatrixProduct( const FSWMatrixView & matrixA, const FSWMatrixView & matrixB );
+    static TArray< float > MatrixVectorProduct( const FSWMatrixView & matrix, TArray< float > & vector );
+    static FSWMatrix MatrixInverse( const FSWMatrixView & matrix );
+    static TArray< float > HelperSolve( const FSWMatrixView & luMatrix, TArray< float > & b );
+    static FSWMatrix MatrixDecompose( const FSWMatrixView & matrix, TArray< int > & perm, int & tog );
 };
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+// Read-only view on a row-major block of floats.
+// RowStride is the distance (in floats) between two consecutive rows, so a view can
+// cover a sub-block of a bigger matrix (some rows, some columns) without copying it.
+struct FSWMatrixView
+{
+    FSWMatrixView() = default;
+
+    FSWMatrixView( const float * data, const int rows, const int cols, const int rowStride )
+        : Data( data ), Rows( rows ), Cols( cols ), RowStride( rowStride )
+    {}
+
+    int Num() const
+    {
+        return Rows;
+    }
+
+    bool IsEmpty() const
+    {
+        return Rows == 0 || Cols == 0;
+    }
+
+    const float * Row( const int row ) const
+    {
+        return Data + row * RowStride;
+    }
+
+    float operator()( const int row, const int col ) const
+    {
+        return Data[ row * RowStride + col ];
+    }
+
+    // nbRows lines starting at firstRow, same columns
+    FSWMatrixView RowRange( const int firstRow, const int nbRows ) const
+    {
+        return FSWMatrixView( Row( firstRow ), nbRows, Cols, RowStride );
+    }
+
+    // nbCols columns starting at firstCol, same lines
+    FSWMatrixView ColRange( const int firstCol, const int nbCols ) const
+    {
+        return FSWMatrixView( Data + firstCol, Rows, nbCols, RowStride );
+    }
+
+    const float * Data = nullptr;
+    int Rows = 0;
+    int Cols = 0;
+    int RowStride = 0;
+};
+
+// Dense row-major matrix stored in a single allocation.
+// Replaces TArray< TArray< float > > : one heap block instead of one per row.
+struct FSWMatrix
+{
+    FSWMatrix() = default;
+
+    FSWMatrix( const int rows, const int cols )
+    {
+        Init( rows, cols );
+    }
+
+    // Resize and fill with 0.0. Keeps the allocation if it is big enough.
+    void Init( const int rows, const int cols )
+    {
+        Rows = rows;
+        Cols = cols;
+        Data.Reset( rows * cols );
+        Data.AddZeroed( rows * cols );
+    }
+
+    // Same as Init but the content is left undefined (everything will be written by the caller)
+    void SetSizeUninitialized( const int rows, const int cols )
+    {
+        Rows = rows;
+        Cols = cols;
+        Data.Reset( rows * cols );
+        Data.AddUninitialized( rows * cols );
+    }
+
+    void Empty()
+    {
+        Rows = 0;
+        Cols = 0;
+        Data.Empty();
+    }
+
+    int Num() const
+    {
+        return Rows;
+    }
+
+    bool IsEmpty() const
+    {
+        return Rows == 0 || Cols == 0;
+    }
+
+    float * Row( const int row )
+    {
+        return Data.GetData() + row * Cols;
+    }
+
+    const float * Row( const int row ) const
+    {
+        return Data.GetData() + row * Cols;
+    }
+
+    float & operator()( const int row, const int col )
+    {
+        return Data[ row * Cols + col ];
+    }
+
+    float operator()( const int row, const int col ) const
+    {
+        return Data[ row * Cols + col ];
+    }
+
+    FSWMatrixView View() const
+    {
+        return FSWMatrixView( Data.GetData(), Rows, Cols, Cols );
+    }
+
+    operator FSWMatrixView() const
+    {
+        return View();
+    }
+
+    TArray< float > Data;
+    int Rows = 0;
+    int Cols = 0;
+};
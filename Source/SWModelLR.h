@@ -25,4 +25,5 @@ public:
     float InvPredict( float proba, TArray< float > values = TArray<float>(), int varToSet = 0 );
 
     TArray< float > Betas;
+    int FailedPivot = -1; //Pivot de X'WX qui n'a pas pu etre factorise pendant le calcul des betas (-1 si aucun)
 };
@@ -0,0 +1,125 @@
+#include "SWOnlineLR.h"
+
+void FSWOnlineLR::Init( const int nbVars, const float priorVariance, const float forgettingFactor )
+{
+    Reset();
+
+    NbBetas = nbVars + 1;
+    PriorVariance = priorVariance;
+    ForgettingFactor = FMath::Clamp( forgettingFactor, 0.01f, 1.0f );
+
+    //Prior : N(0, PriorVariance * I)
+    Mean.AddZeroed( NbBetas );
+    Covariance.AddZeroed( NbBetas * NbBetas );
+    for ( auto i = 0; i < NbBetas; ++i )
+        Covariance[ i * NbBetas + i ] = PriorVariance;
+}
+
+void FSWOnlineLR::Reset()
+{
+    Mean.Empty();
+    Covariance.Empty();
+    NbBetas = 0;
+    NbSamples = 0;
+    NbWins = 0;
+    NbFails = 0;
+    NbCorrect = 0;
+    NbUpdates = 0;
+}
+
+double FSWOnlineLR::Dot( const float * thetas, const double * vector ) const
+{
+    //x = [ 1, thetas ]
+    auto result = vector[ 0 ];
+    for ( auto i = 1; i < NbBetas; ++i )
+        result += thetas[ i - 1 ] * vector[ i ];
+    return result;
+}
+
+void FSWOnlineLR::Update( const float * thetas, const float result )
+{
+    if ( !IsInitialized() )
+        throw new std::exception( "Online logistic regression not initialized" );
+
+    const auto p = NbBetas;
+    auto * sigma = Covariance.GetData();
+
+    //Oubli : on gonfle la covariance (les anciens essais comptent moins)
+    //Une direction jamais observee ne doit pas exploser : sa variance est bornee par celle du prior
+    if ( ForgettingFactor < 1 )
+    {
+        for ( auto i = 0; i < p * p; ++i )
+            sigma[ i ] /= ForgettingFactor;
+
+        for ( auto i = 0; i < p; ++i )
+        {
+            const auto variance = sigma[ i * p + i ];
+            if ( variance > PriorVariance )
+            {
+                //D * Sigma * D avec D diagonale <= 1 : reste symetrique definie positive
+                const auto scale = FMath::Sqrt( PriorVariance / variance );
+                for ( auto j = 0; j < p; ++j )
+                {
+                    sigma[ i * p + j ] *= scale;
+                    sigma[ j * p + i ] *= scale;
+                }
+            }
+        }
+
+        NbSamples *= ForgettingFactor;
+        NbWins *= ForgettingFactor;
+        NbFails *= ForgettingFactor;
+        NbCorrect *= ForgettingFactor;
+    }
+
+    //Prediction avant mise a jour
+    const auto z = Dot( thetas, Mean.GetData() );
+    const auto prob = 1.0 / ( 1.0 + FMath::Exp( -z ) );
+    const auto won = result > 0;
+
+    NbSamples += 1;
+    NbUpdates++;
+    if ( won )
+        NbWins += 1;
+    else
+        NbFails += 1;
+    if ( ( prob >= 0.5 ) == won )
+        NbCorrect += 1;
+
+    //sx = Sigma * x, v = x' * Sigma * x
+    TArray< double, TInlineAllocator< 8 > > sx;
+    sx.AddUninitialized( p );
+    for ( auto i = 0; i < p; ++i )
+        sx[ i ] = Dot( thetas, sigma + i * p ); //Sigma symetrique : ligne i = colonne i
+    const auto v = Dot( thetas, sx.GetData() );
+
+    //Laplace a un pas autour de la moyenne courante :
+    // mean += sx * (y - p) / (1 + w v)
+    // Sigma -= sx sx' * w / (1 + w v)   (Sherman-Morrison sur Sigma^-1 + w x x')
+    const auto w = FMath::Max( prob * ( 1.0 - prob ), 1e-10 );
+    const auto denominator = 1.0 + w * v;
+    const auto meanStep = ( ( won ? 1.0 : 0.0 ) - prob ) / denominator;
+    const auto covarianceStep = w / denominator;
+
+    for ( auto i = 0; i < p; ++i )
+    {
+        Mean[ i ] += sx[ i ] * meanStep;
+        for ( auto j = 0; j < p; ++j )
+            sigma[ i * p + j ] -= covarianceStep * sx[ i ] * sx[ j ];
+    }
+}
+
+float FSWOnlineLR::PredictMean( const float * thetas ) const
+{
+    if ( !IsInitialized() )
+        return 0.5f;
+
+    return 1.0 / ( 1.0 + FMath::Exp( -Dot( thetas, Mean.GetData() ) ) );
+}
+
+void FSWOnlineLR::GetBetas( TArray< float > & betas ) const
+{
+    betas.Reset( NbBetas );
+    for ( auto i = 0; i < NbBetas; ++i )
+        betas.Add( static_cast< float >( Mean[ i ] ) );
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+// Bayesian logistic regression updated one attempt at a time (assumed density filtering / one-step Laplace).
+// The posterior over the betas is approximated by a gaussian N(Mean, Covariance). Each Update costs O(p^2)
+// where p = number of betas, so it can be called at every attempt instead of refitting on the whole window.
+// The betas follow the USWModelLR layout : Mean[ 0 ] is the constant, Mean[ i + 1 ] goes with thetas[ i ].
+struct SWARMS_API FSWOnlineLR
+{
+    // nbVars : number of thetas per attempt (without the constant)
+    // priorVariance : variance of the N(0, priorVariance * I) prior on the betas
+    // forgettingFactor : in ]0, 1]. 1 : every attempt counts the same. Below 1 the covariance is inflated
+    //  by 1 / forgettingFactor before each update, so old attempts weigh less and less (memory ~ 1 / (1 - forgettingFactor) attempts)
+    void Init( int nbVars, float priorVariance, float forgettingFactor );
+
+    void Reset();
+
+    bool IsInitialized() const
+    {
+        return NbBetas > 0;
+    }
+
+    int GetNbVars() const
+    {
+        return NbBetas - 1;
+    }
+
+    // Add one attempt : result is 1 for a win, 0 for a fail
+    void Update( const float * thetas, float result );
+
+    // Probability of success for these thetas with the betas at the mean of the posterior
+    float PredictMean( const float * thetas ) const;
+
+    // Mean of the posterior, as floats (same layout as USWModelLR::Betas)
+    void GetBetas( TArray< float > & betas ) const;
+
+    // Prequential accuracy : each attempt is predicted before being used to update the model. Between 0 and 1
+    float Accuracy() const
+    {
+        return NbSamples > 0 ? NbCorrect / NbSamples : 0.f;
+    }
+
+    TArray< double > Mean;       //NbBetas
+    TArray< double > Covariance; //NbBetas x NbBetas, row-major
+    int NbBetas = 0;
+    double PriorVariance = 100;
+    double ForgettingFactor = 1;
+
+    //Compteurs ponderes par l'oubli (avec ForgettingFactor = 1 ce sont les comptes exacts)
+    float NbSamples = 0;
+    float NbWins = 0;
+    float NbFails = 0;
+    float NbCorrect = 0;
+    int NbUpdates = 0; //Nombre d'essais vus depuis Init, sans oubli
+
+private:
+    double Dot( const float * thetas, const double * vector ) const;
+};
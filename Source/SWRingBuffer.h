@@ -0,0 +1,122 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+// Fixed-capacity circular buffer : Add is O(1) and overwrites the oldest element once the buffer is full.
+// Every element is written twice (slot i and slot i + capacity), so the content is always readable
+// oldest first as one contiguous view, without copy. Element 0 is the oldest one.
+template< typename T >
+class TSWRingBuffer
+{
+public:
+    // Empties the buffer and allocates room for capacity elements
+    void Init( const int capacity )
+    {
+        Capacity = FMath::Max( capacity, 0 );
+        Head = 0;
+        Count = 0;
+        Storage.Reset( 2 * Capacity );
+        Storage.AddDefaulted( 2 * Capacity );
+    }
+
+    // Empties the buffer, keeps its capacity
+    void Reset()
+    {
+        Head = 0;
+        Count = 0;
+    }
+
+    int Num() const
+    {
+        return Count;
+    }
+
+    int Max() const
+    {
+        return Capacity;
+    }
+
+    bool IsEmpty() const
+    {
+        return Count == 0;
+    }
+
+    bool IsFull() const
+    {
+        return Count == Capacity;
+    }
+
+    void Add( const T & item )
+    {
+        if ( Capacity == 0 )
+            return;
+
+        auto slot = Head + Count;
+        if ( Count == Capacity )
+        {
+            //Plein : le nouvel element prend la place du plus ancien
+            slot = Head;
+            Head = Head + 1 == Capacity ? 0 : Head + 1;
+        }
+        else
+        {
+            ++Count;
+        }
+
+        if ( slot >= Capacity )
+            slot -= Capacity;
+        Storage[ slot ] = item;
+        Storage[ slot + Capacity ] = item;
+    }
+
+    // nbItems elements, one after the other. If every Add uses the same nbItems and the capacity is a multiple of it,
+    // groups of nbItems are never split by the eviction
+    void Add( const T * items, const int nbItems )
+    {
+        for ( auto index = 0; index < nbItems; ++index )
+            Add( items[ index ] );
+    }
+
+    // Heap memory used by the buffer, in bytes
+    SIZE_T GetAllocatedSize() const
+    {
+        return Storage.GetAllocatedSize();
+    }
+
+    const T & operator[]( const int index ) const
+    {
+        return Storage[ Head + index ];
+    }
+
+    const T & Last() const
+    {
+        return Storage[ Head + Count - 1 ];
+    }
+
+    // Everything, oldest first, as one contiguous view
+    TArrayView< const T > GetView() const
+    {
+        return TArrayView< const T >( Storage.GetData() + Head, Count );
+    }
+
+    // The nbLast most recent elements (all of them if there are fewer), oldest first, as one contiguous view
+    TArrayView< const T > GetLastView( const int nbLast ) const
+    {
+        const auto nb = FMath::Clamp( nbLast, 0, Count );
+        return TArrayView< const T >( Storage.GetData() + Head + Count - nb, nb );
+    }
+
+    // Same content as GetView, as it is really laid out in the first copy : first then second (second may be empty)
+    void GetSegments( TArrayView< const T > & first, TArrayView< const T > & second ) const
+    {
+        const auto nbFirst = FMath::Min( Count, Capacity - Head );
+        first = TArrayView< const T >( Storage.GetData() + Head, nbFirst );
+        second = TArrayView< const T >( Storage.GetData(), Count - nbFirst );
+    }
+
+private:
+    TArray< T > Storage; //2 * Capacity : slots [0, Capacity[ and their copy
+    int Capacity = 0;
+    int Head = 0;  //Slot of the oldest element
+    int Count = 0;
+};